@@ -8,17 +8,31 @@ void audio_push_samples(float *samples, uint32_t len, uint8_t channels)
 
     if (channels == platform->settings->audio_channels)
     {
-        ring_push(audio_buffer, samples, len, false);
+        spsc_push(audio_buffer, samples, len);
     }
     else
     {
-        for (uint32_t i = 0; i < len; i+= channels)
+        /// remap channels through a small staging chunk so the ring still receives bulk pushes
+        float staging[APP_AUDIO_STAGING_LEN];
+        uint32_t staged = 0;
+        uint8_t out_channels = platform->settings->audio_channels;
+
+        for (uint32_t i = 0; i + channels <= len; i += channels)
         {
-            for (uint8_t j = 0; j < platform->settings->audio_channels; j++)
+            for (uint8_t j = 0; j < out_channels; j++)
             {
-                ring_push(audio_buffer, samples+i+j, 1, false);
+                staging[staged++] = samples[i + (j % channels)];
+            }
+
+            if (staged + out_channels > APP_AUDIO_STAGING_LEN)
+            {
+                /// ring is full, the rest of the clip would be dropped anyway
+                if (spsc_push(audio_buffer, staging, staged) < staged) return;
+                staged = 0;
             }
         }
+
+        spsc_push(audio_buffer, staging, staged);
     }
 }
 
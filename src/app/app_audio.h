@@ -3,6 +3,8 @@
 
 #include "app_common.h"
 
+#define APP_AUDIO_STAGING_LEN (512)
+
 void audio_push_samples(float *samples, uint32_t len, uint8_t channels);
 void audio_push_clip(AudioClip_t *clip);
 
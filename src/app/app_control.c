@@ -2,6 +2,7 @@
 #include "app_common.h"
 #include "app_memory.h"
 #include "app_gfx.h"
+#include "app_rewind.h"
 
 static void input_process_state(AppControlIndex_t idx)
 {
@@ -20,6 +21,14 @@ static void input_process_state(AppControlIndex_t idx)
         case APPCTRLEVT_NONE:
             break;
         case APPCTRLEVT_DOWN:
+            switch (idx)
+            {
+                case APPCTRLIDX_REWIND:
+                    rewind_step_back();
+                    break;
+                default:
+                    break;
+            }
             break;
         case APPCTRLEVT_UP:
             switch (idx)
@@ -30,6 +39,8 @@ static void input_process_state(AppControlIndex_t idx)
                     break;
                 case APPCTRLIDX_LOAD:
                     platform->storage_load_state("test_save");
+                    /// a packed load already reset it in app_deserialize(), a raw one replaced the state behind its back
+                    rewind_reset();
                     break;
                 case APPCTRLIDX_SAVE:
                     platform->storage_save_state("test_save");
@@ -37,6 +48,12 @@ static void input_process_state(AppControlIndex_t idx)
                 case APPCTRLIDX_QUIT:
                     platform->set_should_terminate(true);
                     break;
+                case APPCTRLIDX_REWIND:
+                    rewind_log_position();
+                    break;
+                case APPCTRLIDX_RESTORE:
+                    rewind_restore();
+                    break;
                 case APPCTRLIDX_VOLUME_UP:
                     platform->audio_set_volume(platform->audio_get_volume() + 0.1f);
                     break;
@@ -70,6 +87,9 @@ static void input_process_state(AppControlIndex_t idx)
                 case APPCTRLIDX_MOVE_RIGHT:
                     entity_move(serializables->controlled_entity_idx, serializables->mov_speed, 0);
                     break;
+                case APPCTRLIDX_REWIND:
+                    rewind_step_back();
+                    break;
                 default:
                     break;
             }
@@ -85,26 +105,30 @@ void input_process_all(void)
     }
 }
 
-bool input_read_from_buffer(UniformRing_t *input_buffer, InputEvent_t *out)
+uint32_t input_read_from_buffer(Ring_InputEvent_t *input_buffer, InputEvent_t *out, uint32_t max_count)
 {
-    if (input_buffer == NULL) return false;
-    return ring_pop(input_buffer, out);
+    if (input_buffer == NULL) return 0;
+    return ring_InputEvent_t_pop(input_buffer, out, max_count);
 }
 
 void input_read_all(void)
 {
     if (platform == NULL || serializables == NULL) return;
 
-    InputEvent_t input = {0};
+    InputEvent_t inputs[APP_INPUT_READ_BATCH_LEN] = {0};
+    uint32_t input_count = 0;
 
-    while(input_read_from_buffer(input_buffer, &input))
+    while((input_count = input_read_from_buffer(input_buffer, inputs, APP_INPUT_READ_BATCH_LEN)) > 0)
     {
-        for (uint16_t k = 0; k < APP_CONTROL_COUNT; k++)
+        for (uint32_t i = 0; i < input_count; i++)
         {
-            if (serializables->controller_mapping[k] == input.key)
+            for (uint16_t k = 0; k < APP_CONTROL_COUNT; k++)
             {
-                ephemerals->controller_state.latest[k] = input.value;
-                break;
+                if (serializables->controller_mapping[k] == inputs[i].key)
+                {
+                    ephemerals->controller_state.latest[k] = inputs[i].value;
+                    break;
+                }
             }
         }
     }
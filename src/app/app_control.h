@@ -3,7 +3,8 @@
 
 #include "common_structs.h"
 
-#define APP_CONTROL_COUNT (12)
+#define APP_CONTROL_COUNT (14)
+#define APP_INPUT_READ_BATCH_LEN (16)
 
 typedef enum AppControlIndex
 {
@@ -20,6 +21,8 @@ typedef enum AppControlIndex
     APPCTRLIDX_VOLUME_DOWN = 9,
     APPCTRLIDX_DEBUG_GFX = 10,
     APPCTRLIDX_RELOAD_EPH = 11,
+    APPCTRLIDX_REWIND = 12,
+    APPCTRLIDX_RESTORE = 13,
 } AppControlIndex_t;
 
 typedef enum AppControlEventType
@@ -41,7 +44,7 @@ typedef struct AppControllerState
 } AppControllerState_t;
 
 void input_process_all(void);
-bool input_read_from_buffer(UniformRing_t *input_buffer, InputEvent_t *out);
+uint32_t input_read_from_buffer(Ring_InputEvent_t *input_buffer, InputEvent_t *out, uint32_t max_count);
 void input_read_all(void);
 
 #endif
@@ -131,6 +131,9 @@ void entities_initialize_draw_order(void)
             ephemerals->entities_draw_order_layer_offsets[layer] = i;
         }
     }
+
+    /// static layers are sorted once here, since entities_update_draw_order() leaves them alone
+    entities_sort_layers(0, APP_STATIC_LAYER_COUNT);
 }
 
 void entity_set_pos(uint32_t entity_id, int32_t x, int32_t y)
@@ -190,20 +193,19 @@ void entities_sort_by_comparer(uint32_t start_idx, uint32_t end_idx, int8_t (*co
     }
 }
 
-void entities_update_draw_order(void)
+/**
+ * @brief Sorts each layer from 'first_layer' up to (excluding) 'end_layer' by y, within its draw order range.
+ */
+void entities_sort_layers(uint8_t first_layer, uint8_t end_layer)
 {
     Scene_t *scene = &serializables->scenes[serializables->current_scene_index];
 
-    if (scene->entity_count <= 0)
-    {
-        platform->debug_log("Cannot update draw order - entity count is zero!");
-        return;
-    }
+    if (scene->entity_count <= 0) return;
 
     int32_t start_idx = 0;
     int32_t end_idx = 0;
 
-    for (int8_t i = 0; i < APP_LAYER_COUNT; i++)
+    for (int8_t i = first_layer; i < end_layer; i++)
     {
         start_idx = ephemerals->entities_draw_order_layer_offsets[i];
 
@@ -230,6 +232,40 @@ void entities_update_draw_order(void)
     }
 }
 
+/**
+ * @brief Re-sorts the layers that can move. The static layers never change order between
+ * entities_initialize_draw_order() calls, so they are skipped.
+ */
+void entities_update_draw_order(void)
+{
+    Scene_t *scene = &serializables->scenes[serializables->current_scene_index];
+
+    if (scene->entity_count <= 0)
+    {
+        platform->debug_log("Cannot update draw order - entity count is zero!");
+        return;
+    }
+
+    entities_sort_layers(APP_STATIC_LAYER_COUNT, APP_LAYER_COUNT);
+}
+
+/**
+ * @brief Returns the draw order index where the first non-static layer begins,
+ * i.e. the number of entities on static layers.
+ */
+int32_t entities_get_static_end(void)
+{
+    for (uint8_t i = APP_STATIC_LAYER_COUNT; i < APP_LAYER_COUNT; i++)
+    {
+        if (ephemerals->entities_draw_order_layer_offsets[i] >= 0)
+        {
+            return ephemerals->entities_draw_order_layer_offsets[i];
+        }
+    }
+
+    return serializables->scenes[serializables->current_scene_index].entity_count;
+}
+
 void entities_get_distance(uint16_t first_entity_id, uint16_t second_entity_id, int32_t *x_dist_out, int32_t *y_dist_out)
 {
     Scene_t *scene = &serializables->scenes[serializables->current_scene_index];
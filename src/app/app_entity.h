@@ -92,6 +92,8 @@ SoundEmitter_t* entity_get_sounds(uint16_t entity_idx);
 int32_t entity_create(int32_t scene_idx, uint16_t definition_idx, bool local_def, uint8_t layer, int32_t x, int32_t y);
 void entities_initialize_draw_order(void);
 void entities_update_draw_order(void);
+void entities_sort_layers(uint8_t first_layer, uint8_t end_layer);
+int32_t entities_get_static_end(void);
 void entities_get_distance(uint16_t first_entity_id, uint16_t second_entity_id, int32_t *x_dist_out, int32_t *y_dist_out);
 uint16_t entity_test_collision(uint16_t entity_id);
 void entity_move(uint16_t entity_idx, int16_t x_delta, int16_t y_delta);
@@ -5,6 +5,8 @@
 #include "app_scene.h"
 #include "app_gfx.h"
 #include "app_control.h"
+#include "app_rewind.h"
+#include "app_gfx_kernels.h"
 
 /// must match prototype @ref AppSetupFunc
 void app_setup(Platform_t *interface)
@@ -15,25 +17,39 @@ void app_setup(Platform_t *interface)
 
     platform->settings->gfx_frame_time_target_us = 16666;
 
-    platform->settings->gfx_pixel_size_bytes = 3;
+    /// prefer the word-sized format, so textures and the gfx buffer match what the platform presents
+    uint32_t formats = platform->capabilities->gfx_pixel_formats;
+    platform->settings->gfx_pixel_format =
+        (formats & PIXEL_FORMAT_BIT(PIXEL_FORMAT_XRGB8888)) ? PIXEL_FORMAT_XRGB8888
+        : (formats & PIXEL_FORMAT_BIT(PIXEL_FORMAT_RGB24)) ? PIXEL_FORMAT_RGB24
+        : PIXEL_FORMAT_INDEX8;
+    platform->settings->gfx_pixel_size_bytes = pixel_format_size_bytes(platform->settings->gfx_pixel_format);
     platform->settings->gfx_buffer_width = APP_GFX_TILE_WIDTH_PX * APP_GFX_VIEWPORT_WIDTH_TILES;
     platform->settings->gfx_buffer_height = APP_GFX_TILE_HEIGHT_PX * APP_GFX_VIEWPORT_HEIGHT_TILES;
+    platform->settings->gfx_command_capacity = APP_GFX_COMMAND_CAPACITY;
 
     size_t required_gfx_memory = 
     platform->settings->gfx_pixel_size_bytes *
     platform->settings->gfx_buffer_width *
     platform->settings->gfx_buffer_height;
 
+    if (platform->settings->gfx_command_capacity > 0)
+    {
+        required_gfx_memory += render_list_required_bytes(platform->settings->gfx_command_capacity);
+    }
+
     platform->settings->audio_channels = 2;
     platform->settings->audio_buffer_capacity = 32768;
 
     platform->settings->input_buffer_capacity = 128;
 
+    platform->settings->worker_thread_count = APP_GFX_WORKER_THREADS;
+
     size_t required_state_memory = sizeof(AppSerializableState_t) + sizeof(AppEphemeralState_t);
 
     size_t required_memory_total = required_state_memory + required_gfx_memory
-        + sizeof(UniformRing_t) + (sizeof(float) * platform->settings->audio_buffer_capacity)
-        + sizeof(UniformRing_t) + (sizeof(int) * platform->settings->input_buffer_capacity);
+        + spsc_required_bytes(platform->settings->audio_buffer_capacity, sizeof(float))
+        + ring_InputEvent_t_required_bytes(platform->settings->input_buffer_capacity);
     
     bool sufficient = platform->capabilities->app_memory_max_bytes >= required_memory_total;
 
@@ -72,15 +88,26 @@ void app_init(const Platform_t *interface, AppMemoryPartition_t *memory)
 
     input_buffer = memory->input_buffer;
     gfx_buffer = memory->gfx_buffer;
+    gfx_dirty = memory->gfx_dirty;
+    gfx_commands = memory->gfx_commands;
     audio_buffer = memory->audio_buffer;
     ephemerals = (AppEphemeralState_t *)memory->ephemeral->buffer;
     serializables = (AppSerializableState_t *)memory->serializable->buffer;
 
+    snprintf(ephemerals->debug_buff, sizeof(ephemerals->debug_buff), "Using the %s keyed blit kernels.", gfx_kernels_init());
+    platform->debug_log(ephemerals->debug_buff);
+
     /// EPHEMERALS
     load_ephemerals();
 
     /// SERIALIZABLES
 
+    if (serializables->initialized && serializables->layout_version != APP_STATE_PACK_VERSION)
+    {
+        platform->debug_log("Loaded serializable state is from another layout, discarding it.");
+        serializables->initialized = false;
+    }
+
     if (serializables->initialized)
     {
         platform->debug_log("Loaded serializable state already initialized.");
@@ -90,6 +117,7 @@ void app_init(const Platform_t *interface, AppMemoryPartition_t *memory)
         platform->debug_log("Initializing app serializable state.");
 
         explicit_bzero(serializables, sizeof(*serializables));
+        serializables->layout_version = APP_STATE_PACK_VERSION;
 
         /// initialize default hardcoded control mapping
         /// TODO: load control config from text file
@@ -105,6 +133,8 @@ void app_init(const Platform_t *interface, AppMemoryPartition_t *memory)
         serializables->controller_mapping[APPCTRLIDX_VOLUME_DOWN] = '-';
         serializables->controller_mapping[APPCTRLIDX_DEBUG_GFX] = '0';
         serializables->controller_mapping[APPCTRLIDX_RELOAD_EPH] = '9';
+        serializables->controller_mapping[APPCTRLIDX_REWIND] = 'r';
+        serializables->controller_mapping[APPCTRLIDX_RESTORE] = 'f';
 
         load_scene_by_index(0);
 
@@ -117,6 +147,8 @@ void app_init(const Platform_t *interface, AppMemoryPartition_t *memory)
 
     entities_initialize_draw_order();
     entities_update_draw_order();
+
+    rewind_reset();
 }
 
 /// must match prototype @ref AppLoopFunc
@@ -124,11 +156,12 @@ void app_loop(void)
 {
     input_read_all();
     input_process_all();
+    rewind_record();
     entities_update_draw_order();
-    gfx_clear_buffer();
 
     if(debug_gfx)
     {
+        gfx_clear_buffer();
         gfx_draw_all_entities_debug();
     }
     else
@@ -141,3 +174,35 @@ void app_loop(void)
 void app_exit(void)
 {
 }
+
+/**
+ * @brief Packs the serializable state for saving, see state_serialize().
+ * Must match prototype @ref AppSerializeFunc.
+ */
+size_t app_serialize(void *dest, size_t max_len)
+{
+    if (serializables == NULL) return 0;
+
+    return state_serialize(dest, max_len);
+}
+
+/**
+ * @brief Restores packed serializable state and rebuilds what derives from it.
+ * Must match prototype @ref AppDeserializeFunc.
+ */
+bool app_deserialize(const void *src, size_t len)
+{
+    if (serializables == NULL || !state_deserialize(src, len))
+    {
+        return false;
+    }
+
+    entities_initialize_draw_order();
+    entities_update_draw_order();
+    gfx_mark_all_dirty();
+
+    /// the loaded state is the new baseline, rewinding stops at the load
+    rewind_reset();
+
+    return true;
+}
@@ -6,9 +6,23 @@
 #include "app_memory.h"
 #include "app_scene.h"
 #include "app_entity.h"
+#include "app_gfx_kernels.h"
+#include "app_spatial.h"
 
 bool debug_gfx = false;
 
+/// drawing is confined to this rectangle, which also gets clipped to the gfx buffer;
+/// per thread, as each band drawing in parallel has its own
+static __thread GfxRect_t gfx_clip = { 0, 0, INT16_MAX, INT16_MAX };
+
+/// the shared parameters of one frame's band jobs
+typedef struct GfxBandBatch
+{
+    bool use_cache;
+    uint16_t first_rank;
+    int32_t band_height;
+} GfxBandBatch_t;
+
 void gfx_world_to_screen_coords(int16_t *x_ptr, int16_t *y_ptr)
 {
     Scene_t *scene = &serializables->scenes[serializables->current_scene_index];
@@ -23,41 +37,253 @@ void gfx_world_to_screen_coords(int16_t *x_ptr, int16_t *y_ptr)
     *y_ptr -= scene->entities[serializables->focal_entity_idx].transform.y_pos * APP_GFX_TILE_HEIGHT_PX;
 }
 
+/**
+ * @brief Appends a draw to the platform's render command list, see RenderCommand_t.
+ * Only used in render command mode, where the app never touches the gfx buffer pixels.
+ */
+static void gfx_emit(RenderCommandType_t type, uint8_t flags, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t value)
+{
+    RenderCommand_t command = { type, flags, x0, y0, x1, y1, 0, value };
+    render_list_push(gfx_commands, command);
+}
+
+static GfxRect_t gfx_buffer_rect(void)
+{
+    GfxRect_t rect = { 0, 0, gfx_buffer->width, gfx_buffer->height };
+    return rect;
+}
+
 void gfx_clear_buffer(void)
 {
     if (gfx_buffer == NULL) return;
+
+    if (gfx_commands != NULL)
+    {
+        gfx_emit(RENDER_COMMAND_FILL_RECT, 0, 0, 0, gfx_buffer->width, gfx_buffer->height, 0);
+        return;
+    }
+
     memset(gfx_buffer->pixels, 0,
     gfx_buffer->width * gfx_buffer->height * gfx_buffer->pixel_size_bytes);
 }
 
+/// the part of the gfx buffer drawing may currently touch
+static GfxRect_t gfx_visible_rect(void)
+{
+    return rect_intersect(gfx_clip, gfx_buffer_rect());
+}
+
+static void gfx_clear_rect(GfxRect_t rect)
+{
+    const size_t pixel_size = gfx_buffer->pixel_size_bytes;
+
+    if (gfx_commands != NULL)
+    {
+        gfx_emit(RENDER_COMMAND_FILL_RECT, 0, rect.x, rect.y, rect.x + rect.w, rect.y + rect.h, 0);
+        return;
+    }
+
+    for (int32_t y = rect.y; y < rect.y + rect.h; y++)
+    {
+        memset(gfx_buffer->pixels + (pixel_size * (size_t)(rect.x + (y * gfx_buffer->width))), 0, pixel_size * rect.w);
+    }
+}
+
+/**
+ * @brief Forces the next frame to redraw and present the whole buffer,
+ * for changes the per-entity comparison cannot see (reloaded textures, restored state, debug drawing).
+ */
+void gfx_mark_all_dirty(void)
+{
+    if (ephemerals != NULL) ephemerals->gfx_redraw_all = true;
+    if (gfx_dirty != NULL) gfx_dirty->full = true;
+}
+
+/**
+ * @brief Whether the texel at the given byte index counts as transparent, see texel_is_transparent().
+ */
+static bool gfx_texel_is_transparent(const Texture_t *texture, int32_t texture_idx)
+{
+    return texel_is_transparent(&texture->pixels[texture_idx], texture->pixel_size_bytes);
+}
+
+static SpriteRun_t* gfx_sprite_runs_get_runs(const SpriteRuns_t *sprite_runs)
+{
+    return (SpriteRun_t *)(sprite_runs->row_starts + sprite_runs->height + 1);
+}
+
+/**
+ * @brief Converts a texture's opaque texels into per-row runs, allocated from the given arena.
+ * Runs are split at the 16-bit length limit, which no texture in practice reaches.
+ *
+ * @retval The compiled runs, or NULL if the arena is exhausted.
+ */
+SpriteRuns_t* gfx_compile_texture_runs(const Texture_t *texture, Arena_t *arena)
+{
+    uint32_t run_count = 0;
+
+    /// first pass only counts, so the allocation is exact
+    for (uint8_t pass = 0; pass < 2; pass++)
+    {
+        SpriteRuns_t *sprite_runs = NULL;
+        SpriteRun_t *runs = NULL;
+
+        if (pass > 0)
+        {
+            size_t size = sizeof(SpriteRuns_t) + ((texture->height + 1) * sizeof(uint32_t)) + (run_count * sizeof(SpriteRun_t));
+            sprite_runs = (SpriteRuns_t *)arena_alloc(arena, size, sizeof(uint32_t));
+
+            if (sprite_runs == NULL) return NULL;
+
+            sprite_runs->height = texture->height;
+            sprite_runs->run_count = run_count;
+            sprite_runs->opaque_count = 0;
+            runs = gfx_sprite_runs_get_runs(sprite_runs);
+            run_count = 0;
+        }
+
+        for (int32_t texture_y = 0; texture_y < texture->height; texture_y++)
+        {
+            if (pass > 0) sprite_runs->row_starts[texture_y] = run_count;
+
+            int32_t texture_x = 0;
+
+            while (texture_x < texture->width)
+            {
+                while (texture_x < texture->width
+                    && gfx_texel_is_transparent(texture, texture->pixel_size_bytes * (texture_x + (texture_y * texture->width))))
+                {
+                    texture_x++;
+                }
+
+                int32_t run_start = texture_x;
+
+                while (texture_x < texture->width && texture_x - run_start < UINT16_MAX
+                    && !gfx_texel_is_transparent(texture, texture->pixel_size_bytes * (texture_x + (texture_y * texture->width))))
+                {
+                    texture_x++;
+                }
+
+                if (texture_x > run_start)
+                {
+                    if (pass > 0)
+                    {
+                        runs[run_count].x = run_start;
+                        runs[run_count].len = texture_x - run_start;
+                        sprite_runs->opaque_count += texture_x - run_start;
+                    }
+
+                    run_count++;
+                }
+            }
+        }
+
+        if (pass > 0)
+        {
+            sprite_runs->row_starts[texture->height] = run_count;
+            return sprite_runs;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Draws a texture from its compiled runs: clips the sprite rectangle once,
+ * then copies each visible opaque run with a single memcpy.
+ * The texture and the buffer must share a pixel size.
+ */
+void gfx_draw_texture_runs(const Texture_t *texture, const SpriteRuns_t *sprite_runs, int start_x, int start_y)
+{
+    if (gfx_buffer == NULL) return;
+
+    const SpriteRun_t *runs = gfx_sprite_runs_get_runs(sprite_runs);
+    const size_t pixel_size = gfx_buffer->pixel_size_bytes;
+    GfxRect_t visible = gfx_visible_rect();
+
+    /// visible texture rectangle, in texture coordinates
+    int32_t min_x = start_x < visible.x ? visible.x - start_x : 0;
+    int32_t min_y = start_y < visible.y ? visible.y - start_y : 0;
+    int32_t max_x = visible.x + visible.w - start_x;
+    int32_t max_y = visible.y + visible.h - start_y;
+
+    if (max_x > texture->width) max_x = texture->width;
+    if (max_y > texture->height) max_y = texture->height;
+    if (min_x >= max_x) return;
+
+    for (int32_t texture_y = min_y; texture_y < max_y; texture_y++)
+    {
+        uint8_t *buffer_row = gfx_buffer->pixels + (pixel_size * (size_t)((start_y + texture_y) * gfx_buffer->width));
+        const uint8_t *texture_row = texture->pixels + (pixel_size * (size_t)(texture_y * texture->width));
+
+        for (uint32_t r = sprite_runs->row_starts[texture_y]; r < sprite_runs->row_starts[texture_y + 1]; r++)
+        {
+            int32_t run_start = runs[r].x;
+            int32_t run_end = run_start + runs[r].len;
+
+            if (run_start < min_x) run_start = min_x;
+            if (run_end > max_x) run_end = max_x;
+            if (run_end <= run_start) continue;
+
+            memcpy(buffer_row + (pixel_size * (start_x + run_start)), texture_row + (pixel_size * run_start), pixel_size * (run_end - run_start));
+        }
+    }
+}
+
+/**
+ * @brief Draws an RGB24 or XRGB8888 texture into a buffer of the same format, with transparency tested
+ * by the selected keyed row kernel, after clipping the sprite rectangle once.
+ * Faster than runs for sprites whose transparency is fragmented into many short gaps.
+ */
+void gfx_draw_texture_keyed(const Texture_t *texture, int start_x, int start_y)
+{
+    if (gfx_buffer == NULL) return;
+
+    GfxRect_t visible = gfx_visible_rect();
+
+    int32_t min_x = start_x < visible.x ? visible.x - start_x : 0;
+    int32_t min_y = start_y < visible.y ? visible.y - start_y : 0;
+    int32_t max_x = visible.x + visible.w - start_x;
+    int32_t max_y = visible.y + visible.h - start_y;
+
+    if (max_x > texture->width) max_x = texture->width;
+    if (max_y > texture->height) max_y = texture->height;
+    if (min_x >= max_x) return;
+
+    uint8_t pixel_size = texture->pixel_size_bytes;
+    GfxKeyedRowFunc keyed_row = pixel_size == 4 ? gfx_keyed_row_xrgb : gfx_keyed_row;
+
+    for (int32_t texture_y = min_y; texture_y < max_y; texture_y++)
+    {
+        uint8_t *buffer_row = gfx_buffer->pixels + (pixel_size * (size_t)((start_y + texture_y) * gfx_buffer->width));
+        const uint8_t *texture_row = texture->pixels + (pixel_size * (size_t)(texture_y * texture->width));
+
+        keyed_row(buffer_row + (pixel_size * (start_x + min_x)), texture_row + (pixel_size * min_x), max_x - min_x);
+    }
+}
+
 void gfx_draw_texture(Texture_t *texture, int start_x, int start_y)
 {
     if (gfx_buffer == NULL) return;
 
     int pixel_x;
     int pixel_y;
+    GfxRect_t visible = gfx_visible_rect();
 
     for (int32_t texture_y = 0; texture_y < texture->height; texture_y++)
     {
         pixel_y = start_y + texture_y;
-        if (pixel_y >= gfx_buffer->height || pixel_y < 0) continue;
+        if (pixel_y >= visible.y + visible.h || pixel_y < visible.y) continue;
 
         for (int32_t texture_x = 0; texture_x < texture->width; texture_x++)
         {
             pixel_x = start_x + texture_x;
-            if (pixel_x >= gfx_buffer->width  || pixel_x < 0) continue;
+            if (pixel_x >= visible.x + visible.w || pixel_x < visible.x) continue;
 
             int32_t texture_idx = texture->pixel_size_bytes * (texture_x + (texture_y * texture->width));
             int32_t buffer_idx = gfx_buffer->pixel_size_bytes * (pixel_x + (pixel_y * gfx_buffer->width));
 
-            /// extremely dumb alpha test
-            /// TODO: somehow move this responsibility to the platform side
-            if ((texture->pixel_size_bytes == 1 && texture->pixels[texture_idx] > 64)
-             || (texture->pixel_size_bytes == 3 && (texture->pixels[texture_idx] + texture->pixels[texture_idx+1] + texture->pixels[texture_idx+2] < 32))
-             || (texture->pixel_size_bytes == 4 && texture->pixels[texture_idx+3] == 0))
-            {
-                continue;
-            }
+            if (gfx_texel_is_transparent(texture, texture_idx)) continue;
 
             for (uint8_t i = 0; i < gfx_buffer->pixel_size_bytes; i++)
             {
@@ -87,6 +313,18 @@ void gfx_debug_draw_collider(uint32_t thing_idx, uint32_t draw_val)
     gfx_world_to_screen_coords(&min_x, &min_y);
     gfx_world_to_screen_coords(&max_x, &max_y);
 
+    if (gfx_commands != NULL)
+    {
+        /// every byte of the outline's pixels is set to the value, whatever the pixel size
+        uint32_t value = (draw_val & 0xFF) * 0x01010101u;
+
+        gfx_emit(RENDER_COMMAND_LINE, 0, min_x, min_y, max_x, min_y, value);
+        gfx_emit(RENDER_COMMAND_LINE, 0, min_x, max_y, max_x, max_y, value);
+        gfx_emit(RENDER_COMMAND_LINE, 0, min_x, min_y, min_x, max_y, value);
+        gfx_emit(RENDER_COMMAND_LINE, 0, max_x, min_y, max_x, max_y, value);
+        return;
+    }
+
     for (int16_t y = min_y; y <= max_y; y++)
     {
         if (y == min_y || y == max_y)
@@ -94,7 +332,7 @@ void gfx_debug_draw_collider(uint32_t thing_idx, uint32_t draw_val)
             for (int16_t x = min_x; x <= max_x; x++)
             {
                 if (x < 0 || x >= gfx_buffer->width || y < 0 || y >= gfx_buffer->height) continue;
-                uint16_t buffer_idx = gfx_buffer->pixel_size_bytes * (x + (y * gfx_buffer->width));
+                uint32_t buffer_idx = gfx_buffer->pixel_size_bytes * (x + (y * gfx_buffer->width));
 
                 for (int i = 0; i < gfx_buffer->pixel_size_bytes; i++)
                 {
@@ -106,7 +344,7 @@ void gfx_debug_draw_collider(uint32_t thing_idx, uint32_t draw_val)
         {
             if (min_x >= 0 && min_x < gfx_buffer->width && y >= 0 && y < gfx_buffer->height)
             {
-                uint16_t buffer_idx = gfx_buffer->pixel_size_bytes * (min_x + (y * gfx_buffer->width));
+                uint32_t buffer_idx = gfx_buffer->pixel_size_bytes * (min_x + (y * gfx_buffer->width));
 
                 for (int i = 0; i < gfx_buffer->pixel_size_bytes; i++)
                 {
@@ -116,7 +354,7 @@ void gfx_debug_draw_collider(uint32_t thing_idx, uint32_t draw_val)
 
             if (max_x >= 0 && max_x < gfx_buffer->width && y >= 0 && y < gfx_buffer->height)
             {
-                uint16_t buffer_idx = gfx_buffer->pixel_size_bytes * (max_x + (y * gfx_buffer->width));
+                uint32_t buffer_idx = gfx_buffer->pixel_size_bytes * (max_x + (y * gfx_buffer->width));
 
                 for (int i = 0; i < gfx_buffer->pixel_size_bytes; i++)
                 {
@@ -127,24 +365,271 @@ void gfx_debug_draw_collider(uint32_t thing_idx, uint32_t draw_val)
     }
 }
 
-void gfx_draw_thing(uint32_t thing_idx)
+/**
+ * @brief The screen rectangle covered by a thing's sprite, empty if the thing is unused.
+ */
+static GfxRect_t gfx_thing_screen_rect(uint32_t thing_idx)
 {
+    GfxRect_t rect = { 0, 0, 0, 0 };
     Scene_t *scene = &serializables->scenes[serializables->current_scene_index];
 
-    if (!scene->entities[thing_idx].used) return;
+    if (!scene->entities[thing_idx].used) return rect;
 
-    size_t texture_offset = ephemerals->texture_offsets[entity_get_sprite(thing_idx)->texture_idx];
-    Texture_t *texture_ptr = (Texture_t *)(ephemerals->bump_buffer+texture_offset);
+    Sprite_t *sprite = entity_get_sprite(thing_idx);
+    Texture_t *texture_ptr = (Texture_t *)(ephemerals->bump_buffer+ephemerals->texture_offsets[sprite->texture_idx]);
 
     int16_t x = scene->entities[thing_idx].transform.x_pos;
     int16_t y = scene->entities[thing_idx].transform.y_pos;
 
     gfx_world_to_screen_coords(&x, &y);
 
-    x -= entity_get_sprite(thing_idx)->x_offset;
-    y -= entity_get_sprite(thing_idx)->y_offset;
+    rect.x = x - sprite->x_offset;
+    rect.y = y - sprite->y_offset;
+    rect.w = texture_ptr->width;
+    rect.h = texture_ptr->height;
+
+    return rect;
+}
+
+/**
+ * @brief Draws a thing's sprite with its top-left corner at the given buffer position,
+ * using the fastest blitter its texture and the buffer allow.
+ */
+static void gfx_blit_thing_at(uint32_t thing_idx, int32_t x, int32_t y)
+{
+    size_t texture_idx = entity_get_sprite(thing_idx)->texture_idx;
+    size_t texture_offset = ephemerals->texture_offsets[texture_idx];
+    size_t runs_offset = ephemerals->texture_run_offsets[texture_idx];
+    Texture_t *texture_ptr = (Texture_t *)(ephemerals->bump_buffer+texture_offset);
+
+    SpriteRuns_t *runs_ptr = runs_offset != 0 ? (SpriteRuns_t *)(ephemerals->bump_buffer+runs_offset) : NULL;
+
+    uint32_t keyed_run_len_min = texture_ptr->pixel_size_bytes == 4 ? APP_GFX_KEYED_XRGB_RUN_LEN_MIN : APP_GFX_KEYED_RUN_LEN_MIN;
+
+    if (runs_ptr != NULL && texture_ptr->pixel_size_bytes >= 3 && texture_ptr->pixel_size_bytes == gfx_buffer->pixel_size_bytes
+        && runs_ptr->opaque_count < runs_ptr->run_count * keyed_run_len_min)
+    {
+        gfx_draw_texture_keyed(texture_ptr, x, y);
+    }
+    else if (runs_ptr != NULL && texture_ptr->pixel_size_bytes == gfx_buffer->pixel_size_bytes)
+    {
+        gfx_draw_texture_runs(texture_ptr, runs_ptr, x, y);
+    }
+    else
+    {
+        gfx_draw_texture(texture_ptr, x, y);
+    }
+}
+
+/**
+ * @brief Byte offset of an ephemeral bump buffer allocation within the ephemeral partition,
+ * which is how render commands refer to textures.
+ */
+static uint32_t gfx_partition_offset(size_t bump_offset)
+{
+    return (uint32_t)((ephemerals->bump_buffer - (uint8_t *)ephemerals) + bump_offset);
+}
+
+/**
+ * @brief Draws a thing's sprite at the given buffer position, or emits the draw in render command mode.
+ */
+static void gfx_draw_thing_at(uint32_t thing_idx, int32_t x, int32_t y)
+{
+    if (gfx_commands != NULL)
+    {
+        size_t texture_offset = ephemerals->texture_offsets[entity_get_sprite(thing_idx)->texture_idx];
+        gfx_emit(RENDER_COMMAND_SPRITE, 0, x, y, 0, 0, gfx_partition_offset(texture_offset));
+        return;
+    }
+
+    gfx_blit_thing_at(thing_idx, x, y);
+}
+
+void gfx_draw_thing(uint32_t thing_idx)
+{
+    Scene_t *scene = &serializables->scenes[serializables->current_scene_index];
+
+    if (!scene->entities[thing_idx].used) return;
+
+    GfxRect_t rect = gfx_thing_screen_rect(thing_idx);
+    gfx_draw_thing_at(thing_idx, rect.x, rect.y);
+}
+
+/**
+ * @brief Forgets the static cache, for when the scene arena holding it is reset.
+ */
+void gfx_release_static_cache(void)
+{
+    ephemerals->static_cache_offset = 0;
+    ephemerals->static_cache_capacity = 0;
+    ephemerals->static_cache_current = false;
+    ephemerals->static_cache_valid = false;
+}
+
+/**
+ * @brief Hashes everything the static layers' appearance depends on,
+ * so that the cache is rebuilt only when a static entity actually changes.
+ */
+static uint64_t gfx_static_signature(void)
+{
+    Scene_t *scene = &serializables->scenes[serializables->current_scene_index];
+    uint64_t hash = 0xcbf29ce484222325ull ^ serializables->current_scene_index;
+
+    for (uint16_t i = 0; i < scene->entity_count; i++)
+    {
+        Entity_t *entity = &scene->entities[i];
+
+        if (!entity->used || entity->layer >= APP_STATIC_LAYER_COUNT) continue;
+
+        Sprite_t *sprite = entity_get_sprite(i);
+        uint64_t fields[4] =
+        {
+            i | ((uint64_t)entity->layer << 16),
+            (uint16_t)entity->transform.x_pos | ((uint64_t)(uint16_t)entity->transform.y_pos << 16),
+            sprite->texture_idx,
+            (uint16_t)sprite->x_offset | ((uint64_t)(uint16_t)sprite->y_offset << 16),
+        };
+
+        for (uint8_t f = 0; f < 4; f++)
+        {
+            hash = (hash ^ fields[f]) * 0x100000001b3ull;
+        }
+    }
 
-    gfx_draw_texture(texture_ptr, x, y);
+    return hash;
+}
+
+/**
+ * @brief Composites every entity on a static layer, in draw order, into a texture covering their bounds,
+ * reusing the previous allocation when it is large enough.
+ * If the scene arena cannot hold it, the static layers are simply drawn every frame instead.
+ */
+static void gfx_build_static_cache(uint64_t signature)
+{
+    int64_t start_us = platform->time_get_monotonic_us();
+
+    ephemerals->static_cache_signature = signature;
+    ephemerals->static_cache_current = true;
+    ephemerals->static_cache_valid = false;
+
+    entities_sort_layers(0, APP_STATIC_LAYER_COUNT);
+    int32_t static_end = entities_get_static_end();
+
+    GfxRect_t bounds = { 0, 0, 0, 0 };
+
+    for (int32_t i = 0; i < static_end; i++)
+    {
+        uint16_t thing_idx = ephemerals->entities_draw_order[i];
+
+        if (!serializables->scenes[serializables->current_scene_index].entities[thing_idx].used) continue;
+
+        bounds = rect_union(bounds, gfx_thing_screen_rect(thing_idx));
+    }
+
+    if (rect_is_empty(bounds) || bounds.w > UINT16_MAX || bounds.h > UINT16_MAX) return;
+
+    size_t size = sizeof(Texture_t) + ((size_t)bounds.w * bounds.h * gfx_buffer->pixel_size_bytes);
+
+    if (ephemerals->static_cache_offset == 0 || size > ephemerals->static_cache_capacity)
+    {
+        void *cache_ptr = arena_alloc(&ephemerals->scene_arena, size, COMMON_SIMD_ALIGNMENT);
+
+        if (cache_ptr == NULL)
+        {
+            snprintf(ephemerals->debug_buff, sizeof(ephemerals->debug_buff),
+                    "Static cache of %dx%d does not fit the scene arena, drawing static layers every frame.", bounds.w, bounds.h);
+            platform->debug_log(ephemerals->debug_buff);
+            return;
+        }
+
+        ephemerals->static_cache_offset = (uint8_t *)cache_ptr - ephemerals->bump_buffer;
+        ephemerals->static_cache_capacity = size;
+    }
+
+    Texture_t *cache = (Texture_t *)(ephemerals->bump_buffer+ephemerals->static_cache_offset);
+    cache->width = bounds.w;
+    cache->height = bounds.h;
+    cache->pixel_size_bytes = gfx_buffer->pixel_size_bytes;
+    memset(cache->pixels, 0, (size_t)cache->width * cache->height * cache->pixel_size_bytes);
+
+    Texture_t *screen_buffer = gfx_buffer;
+    GfxRect_t screen_clip = gfx_clip;
+    GfxRect_t cache_rect = { 0, 0, cache->width, cache->height };
+
+    for (int32_t i = 0; i < static_end; i++)
+    {
+        uint16_t thing_idx = ephemerals->entities_draw_order[i];
+
+        if (!serializables->scenes[serializables->current_scene_index].entities[thing_idx].used) continue;
+
+        /// screen coordinates depend on gfx_buffer, so they are taken before pointing the blitters at the cache
+        GfxRect_t rect = gfx_thing_screen_rect(thing_idx);
+
+        gfx_buffer = cache;
+        gfx_clip = cache_rect;
+        gfx_blit_thing_at(thing_idx, rect.x - bounds.x, rect.y - bounds.y);
+        gfx_buffer = screen_buffer;
+        gfx_clip = screen_clip;
+    }
+
+    int16_t origin_x = 0;
+    int16_t origin_y = 0;
+    gfx_world_to_screen_coords(&origin_x, &origin_y);
+
+    ephemerals->static_cache_x = bounds.x - origin_x;
+    ephemerals->static_cache_y = bounds.y - origin_y;
+    ephemerals->static_cache_valid = true;
+
+    snprintf(ephemerals->debug_buff, sizeof(ephemerals->debug_buff),
+            "Static cache rebuilt: %d entities into %dx%d in %ld us.",
+            static_end, cache->width, cache->height, platform->time_get_monotonic_us() - start_us);
+    platform->debug_log(ephemerals->debug_buff);
+}
+
+/**
+ * @brief Rebuilds the static cache if the scene or any static entity changed since it was built.
+ */
+static void gfx_update_static_cache(void)
+{
+    uint64_t signature = gfx_static_signature();
+
+    if (ephemerals->static_cache_current && signature == ephemerals->static_cache_signature) return;
+
+    gfx_build_static_cache(signature);
+    gfx_mark_all_dirty();
+}
+
+/**
+ * @brief Copies the part of the static cache that falls within the given buffer rectangle.
+ */
+static void gfx_blit_static_cache(GfxRect_t clip)
+{
+    const Texture_t *cache = (const Texture_t *)(ephemerals->bump_buffer+ephemerals->static_cache_offset);
+    const size_t pixel_size = gfx_buffer->pixel_size_bytes;
+
+    int16_t origin_x = 0;
+    int16_t origin_y = 0;
+    gfx_world_to_screen_coords(&origin_x, &origin_y);
+
+    GfxRect_t cache_rect = { origin_x + ephemerals->static_cache_x, origin_y + ephemerals->static_cache_y, cache->width, cache->height };
+
+    if (gfx_commands != NULL)
+    {
+        gfx_emit(RENDER_COMMAND_SPRITE, RENDER_SPRITE_FLAG_OPAQUE, cache_rect.x, cache_rect.y, 0, 0,
+                gfx_partition_offset(ephemerals->static_cache_offset));
+        return;
+    }
+
+    GfxRect_t visible = rect_intersect(cache_rect, clip);
+
+    if (rect_is_empty(visible)) return;
+
+    for (int32_t y = visible.y; y < visible.y + visible.h; y++)
+    {
+        memcpy(gfx_buffer->pixels + (pixel_size * (size_t)(visible.x + (y * gfx_buffer->width))),
+               cache->pixels + (pixel_size * (size_t)((visible.x - cache_rect.x) + ((y - cache_rect.y) * cache->width))),
+               pixel_size * visible.w);
+    }
 }
 
 void gfx_draw_all_entities_debug(void)
@@ -187,14 +672,215 @@ void gfx_draw_all_entities_debug(void)
         step = 0;
         debug_gfx = false;
     }
+
+    gfx_mark_all_dirty();
 }
 
+/**
+ * @brief Compares every thing against how it was last drawn, adding what changed to the dirty list
+ * (if there is one): the old and new rectangles of moved or re-skinned things.
+ * Camera movement, a scene switch or a changed entity count invalidate the whole buffer instead.
+ * Moved things are also moved in the spatial index, which is rebuilt along with a full invalidation.
+ */
+static void gfx_track_things(void)
+{
+    Scene_t *scene = &serializables->scenes[serializables->current_scene_index];
+    GfxRect_t bounds = gfx_buffer_rect();
+
+    int16_t origin_x = 0;
+    int16_t origin_y = 0;
+    gfx_world_to_screen_coords(&origin_x, &origin_y);
+
+    bool scene_changed = ephemerals->gfx_redraw_all
+        || serializables->current_scene_index != ephemerals->drawn_scene_index
+        || scene->entity_count != ephemerals->drawn_entity_count;
+
+    if (scene_changed) spatial_reset();
+
+    if (gfx_dirty != NULL
+        && (scene_changed || origin_x != ephemerals->drawn_origin_x || origin_y != ephemerals->drawn_origin_y))
+    {
+        gfx_dirty->full = true;
+    }
+
+    for (uint16_t i = 0; i < scene->entity_count; i++)
+    {
+        GfxRect_t rect = gfx_thing_screen_rect(i);
+        uint16_t texture_idx = scene->entities[i].used ? entity_get_sprite(i)->texture_idx : 0;
+
+        if (gfx_dirty != NULL
+            && (!rect_equals(rect, ephemerals->drawn_rects[i]) || texture_idx != ephemerals->drawn_textures[i]))
+        {
+            gfx_dirty_add(gfx_dirty, ephemerals->drawn_rects[i], bounds);
+            gfx_dirty_add(gfx_dirty, rect, bounds);
+        }
+
+        /// compared in world space, as the camera keeps the thing it follows still on screen
+        GfxRect_t world_rect = { rect.x - origin_x, rect.y - origin_y, rect.w, rect.h };
+        spatial_update(i, world_rect);
+
+        ephemerals->drawn_rects[i] = rect;
+        ephemerals->drawn_textures[i] = texture_idx;
+    }
+
+    ephemerals->gfx_redraw_all = false;
+    ephemerals->drawn_origin_x = origin_x;
+    ephemerals->drawn_origin_y = origin_y;
+    ephemerals->drawn_scene_index = serializables->current_scene_index;
+    ephemerals->drawn_entity_count = scene->entity_count;
+}
+
+/**
+ * @brief Draws the things overlapping a buffer rectangle, as found by the spatial index,
+ * in draw order from position 'first_rank' on.
+ */
+static void gfx_draw_things_in(GfxRect_t rect, uint16_t first_rank)
+{
+    uint16_t visible[SCENE_ENTITIES_MAX_COUNT];
+
+    int16_t origin_x = 0;
+    int16_t origin_y = 0;
+    gfx_world_to_screen_coords(&origin_x, &origin_y);
+
+    GfxRect_t world_rect = { rect.x - origin_x, rect.y - origin_y, rect.w, rect.h };
+    uint16_t found_count = spatial_query(world_rect, visible, SCENE_ENTITIES_MAX_COUNT);
+    uint16_t kept_count = 0;
+
+    /// insertion sort by draw order in place, cheap for the handful of things in view
+    for (uint16_t i = 0; i < found_count; i++)
+    {
+        uint16_t thing_idx = visible[i];
+        uint16_t rank = ephemerals->entities_draw_rank[thing_idx];
+
+        if (rank < first_rank) continue;
+
+        uint16_t j = kept_count;
+
+        while (j > 0 && ephemerals->entities_draw_rank[visible[j - 1]] > rank)
+        {
+            visible[j] = visible[j - 1];
+            j--;
+        }
+
+        visible[j] = thing_idx;
+        kept_count++;
+    }
+
+    for (uint16_t i = 0; i < kept_count; i++)
+    {
+        gfx_draw_thing_at(visible[i], ephemerals->drawn_rects[visible[i]].x, ephemerals->drawn_rects[visible[i]].y);
+    }
+}
+
+/**
+ * @brief Clears a buffer region and redraws everything within it, clipped to it.
+ */
+static void gfx_draw_region(GfxRect_t region, const GfxBandBatch_t *batch)
+{
+    if (rect_is_empty(region)) return;
+
+    gfx_clip = region;
+    gfx_clear_rect(region);
+    if (batch->use_cache) gfx_blit_static_cache(region);
+    gfx_draw_things_in(region, batch->first_rank);
+}
+
+/**
+ * @brief Redraws the dirty parts of one horizontal band of the buffer, see gfx_draw_all_entities().
+ * Must match prototype @ref WorkerJobFunc.
+ */
+static void gfx_draw_band(void *context, uint32_t band_idx)
+{
+    const GfxBandBatch_t *batch = (const GfxBandBatch_t *)context;
+    GfxRect_t band = { 0, (int32_t)band_idx * batch->band_height, gfx_buffer->width, batch->band_height };
+    band = rect_intersect(band, gfx_buffer_rect());
+
+    if (gfx_dirty == NULL || gfx_dirty->full)
+    {
+        gfx_draw_region(band, batch);
+        return;
+    }
+
+    for (uint32_t r = 0; r < gfx_dirty->count; r++)
+    {
+        gfx_draw_region(rect_intersect(gfx_dirty->rects[r], band), batch);
+    }
+}
+
+/**
+ * @brief Redraws what changed since the last frame.
+ *
+ * @details
+ * Each dirty rectangle is cleared and every thing overlapping it is redrawn in draw order,
+ * clipped to the rectangle so that nothing outside it is painted over out of order.
+ * Without a dirty list from the platform, the whole buffer is redrawn every frame.
+ * Either way, only the things the spatial index finds within view are visited.
+ *
+ * The buffer is split into horizontal bands drawn in parallel on the platform's worker pool.
+ * Every pixel belongs to exactly one band and sees the same draws in the same order,
+ * so the result is identical to drawing on a single thread.
+ *
+ * In render command mode the same draws are emitted for the whole buffer instead,
+ * and the platform rasterizes them (or skips a frame identical to the last one).
+ */
 void gfx_draw_all_entities(void)
 {
+    if (gfx_buffer == NULL) return;
+
     Scene_t *scene = &serializables->scenes[serializables->current_scene_index];
+    int64_t start_us = platform->time_get_monotonic_us();
+
+    gfx_update_static_cache();
+    gfx_track_things();
 
     for (uint16_t i = 0; i < scene->entity_count; i++)
     {
-        gfx_draw_thing(ephemerals->entities_draw_order[i]);
+        ephemerals->entities_draw_rank[ephemerals->entities_draw_order[i]] = i;
+    }
+
+    /// with a valid static cache, the static layers at the start of the draw order are one blit
+    GfxBandBatch_t batch = {0};
+    batch.use_cache = ephemerals->static_cache_valid;
+    batch.first_rank = batch.use_cache ? entities_get_static_end() : 0;
+
+    /// a few bands per thread, so that threads finishing sparse bands early pick up more
+    uint32_t band_count = platform->settings->worker_thread_count > 1
+        ? platform->settings->worker_thread_count * APP_GFX_BANDS_PER_THREAD
+        : 1;
+    batch.band_height = (gfx_buffer->height + band_count - 1) / band_count;
+
+    if (batch.band_height < APP_GFX_BAND_HEIGHT_MIN) batch.band_height = APP_GFX_BAND_HEIGHT_MIN;
+
+    band_count = (gfx_buffer->height + batch.band_height - 1) / batch.band_height;
+
+    if (gfx_commands != NULL)
+    {
+        gfx_draw_region(gfx_buffer_rect(), &batch);
+    }
+    else
+    {
+        platform->workers_run(gfx_draw_band, &batch, band_count);
+    }
+
+    gfx_clip = gfx_buffer_rect();
+
+    ephemerals->draw_report_us += platform->time_get_monotonic_us() - start_us;
+    ephemerals->draw_report_frames++;
+
+    if (ephemerals->draw_report_frames >= APP_GFX_REPORT_FRAMES)
+    {
+        snprintf(ephemerals->debug_buff, sizeof(ephemerals->debug_buff), "Drawing %u entities took %ld us per frame on average.",
+                scene->entity_count, ephemerals->draw_report_us / ephemerals->draw_report_frames);
+        platform->debug_log(ephemerals->debug_buff);
+
+        if (gfx_commands != NULL && gfx_commands->overflowed)
+        {
+            snprintf(ephemerals->debug_buff, sizeof(ephemerals->debug_buff), "Render command list overflowed at %u commands, draws were dropped.",
+                    gfx_commands->capacity);
+            platform->debug_log(ephemerals->debug_buff);
+        }
+
+        ephemerals->draw_report_us = 0;
+        ephemerals->draw_report_frames = 0;
     }
 }
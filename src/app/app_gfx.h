@@ -9,11 +9,51 @@
 #define APP_GFX_VIEWPORT_WIDTH_TILES (80)
 #define APP_GFX_VIEWPORT_HEIGHT_TILES (80)
 
+#define APP_GFX_REPORT_FRAMES (256)
+/// RGB24 sprites whose opaque runs average fewer texels than this are drawn by the keyed row kernel
+#define APP_GFX_KEYED_RUN_LEN_MIN (24)
+/// the same for XRGB8888 sprites, whose runs copy whole 32-bit texels and so win from shorter lengths on
+#define APP_GFX_KEYED_XRGB_RUN_LEN_MIN (12)
+
+/// threads the app asks the platform for, the main thread included
+#define APP_GFX_WORKER_THREADS (4)
+#define APP_GFX_BANDS_PER_THREAD (4)
+#define APP_GFX_BAND_HEIGHT_MIN (16)
+
+/// nonzero asks the platform to rasterize frames from a list of this many render commands at most,
+/// which the app emits instead of drawing into the gfx buffer itself
+#define APP_GFX_COMMAND_CAPACITY (0)
+
+/// a horizontal span of opaque texels within one texture row
+typedef struct SpriteRun
+{
+    uint16_t x;
+    uint16_t len;
+} SpriteRun_t;
+
+/**
+ * A texture's opaque texels as per-row runs, compiled at load time.
+ * 'row_starts' holds height+1 indices and is followed by the runs themselves;
+ * the runs of row y are the ones from row_starts[y] up to row_starts[y+1].
+ */
+typedef struct SpriteRuns
+{
+    uint16_t height;
+    uint32_t run_count;
+    uint32_t opaque_count;
+    uint32_t row_starts[];
+} SpriteRuns_t;
+
 extern bool debug_gfx;
 
 void gfx_world_to_screen_coords(int16_t *x_ptr, int16_t *y_ptr);
 void gfx_clear_buffer(void);
+void gfx_mark_all_dirty(void);
+void gfx_release_static_cache(void);
+SpriteRuns_t* gfx_compile_texture_runs(const Texture_t *texture, Arena_t *arena);
 void gfx_draw_texture(Texture_t *texture, int start_x, int start_y);
+void gfx_draw_texture_keyed(const Texture_t *texture, int start_x, int start_y);
+void gfx_draw_texture_runs(const Texture_t *texture, const SpriteRuns_t *sprite_runs, int start_x, int start_y);
 void gfx_draw_thing(uint32_t thing_idx);
 void gfx_draw_all_entities(void);
 void gfx_debug_draw_collider(uint32_t thing_idx, uint32_t draw_val);
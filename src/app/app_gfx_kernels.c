@@ -0,0 +1,205 @@
+#include "app_gfx_kernels.h"
+
+#ifdef GFX_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+GfxKeyedRowFunc gfx_keyed_row = gfx_keyed_row_scalar;
+GfxKeyedRowFunc gfx_keyed_row_xrgb = gfx_keyed_row_xrgb_scalar;
+
+/**
+ * @brief Reference kernel, and the tail handler of the vector ones.
+ */
+void gfx_keyed_row_scalar(uint8_t *dst, const uint8_t *src, uint32_t pixel_count)
+{
+    for (uint32_t i = 0; i < pixel_count * 3; i += 3)
+    {
+        if (src[i] + src[i+1] + src[i+2] > GFX_KEY_SUM_MAX)
+        {
+            dst[i] = src[i];
+            dst[i+1] = src[i+1];
+            dst[i+2] = src[i+2];
+        }
+    }
+}
+
+/**
+ * @brief Reference XRGB8888 kernel, and the tail handler of the vector ones.
+ */
+void gfx_keyed_row_xrgb_scalar(uint8_t *dst, const uint8_t *src, uint32_t pixel_count)
+{
+    for (uint32_t i = 0; i < pixel_count * 4; i += 4)
+    {
+        if (!texel_is_transparent(&src[i], 4)) memcpy(&dst[i], &src[i], 4);
+    }
+}
+
+#ifdef GFX_KERNELS_X86
+
+/**
+ * Both vector kernels work on chunks of three registers, which hold a whole number of RGB24 texels.
+ * Shifting the chunk down by one and two bytes lines each texel's G and B up under its R,
+ * so two saturating adds leave the channel sum at every texel's first byte.
+ * The key comparison is kept at those bytes only, then smeared over the texel's other two bytes
+ * by shifting it up by one and two bytes, and drives a branchless select between source and destination.
+ * All shifts carry bytes in from the neighbouring register, so nothing outside the chunk is read.
+ */
+
+/// 0xFF at the bytes that start a texel, for each register of a 48 and a 96 byte chunk
+static uint8_t texel_start_pattern_sse2[48] __attribute__((aligned(16)));
+static uint8_t texel_start_pattern_avx2[96] __attribute__((aligned(32)));
+
+static void gfx_kernels_init_patterns(void)
+{
+    for (uint8_t i = 0; i < sizeof(texel_start_pattern_sse2); i++) texel_start_pattern_sse2[i] = (i % 3 == 0) ? 0xFF : 0;
+    for (uint8_t i = 0; i < sizeof(texel_start_pattern_avx2); i++) texel_start_pattern_avx2[i] = (i % 3 == 0) ? 0xFF : 0;
+}
+
+void gfx_keyed_row_sse2(uint8_t *dst, const uint8_t *src, uint32_t pixel_count)
+{
+    const __m128i key_max = _mm_set1_epi8(GFX_KEY_SUM_MAX);
+    uint32_t i = 0;
+
+    for (; i + 16 <= pixel_count; i += 16)
+    {
+        const uint8_t *s = src + (i * 3);
+        uint8_t *d = dst + (i * 3);
+        __m128i s_vec[4];
+        __m128i prev_keyed = _mm_setzero_si128();
+
+        for (uint8_t r = 0; r < 3; r++) s_vec[r] = _mm_loadu_si128((const __m128i *)(s + (r * 16)));
+        s_vec[3] = _mm_setzero_si128();
+
+        for (uint8_t r = 0; r < 3; r++)
+        {
+            __m128i next_1 = _mm_or_si128(_mm_srli_si128(s_vec[r], 1), _mm_slli_si128(s_vec[r+1], 15));
+            __m128i next_2 = _mm_or_si128(_mm_srli_si128(s_vec[r], 2), _mm_slli_si128(s_vec[r+1], 14));
+            __m128i sum = _mm_adds_epu8(s_vec[r], _mm_adds_epu8(next_1, next_2));
+            __m128i keyed = _mm_cmpeq_epi8(_mm_min_epu8(sum, key_max), sum);
+            keyed = _mm_and_si128(keyed, _mm_load_si128((const __m128i *)(texel_start_pattern_sse2 + (r * 16))));
+
+            __m128i smeared = _mm_or_si128(keyed,
+                              _mm_or_si128(_mm_or_si128(_mm_slli_si128(keyed, 1), _mm_srli_si128(prev_keyed, 15)),
+                                           _mm_or_si128(_mm_slli_si128(keyed, 2), _mm_srli_si128(prev_keyed, 14))));
+            prev_keyed = keyed;
+
+            __m128i d_vec = _mm_loadu_si128((const __m128i *)(d + (r * 16)));
+            _mm_storeu_si128((__m128i *)(d + (r * 16)), _mm_or_si128(_mm_and_si128(smeared, d_vec), _mm_andnot_si128(smeared, s_vec[r])));
+        }
+    }
+
+    gfx_keyed_row_scalar(dst + (i * 3), src + (i * 3), pixel_count - i);
+}
+
+__attribute__((target("avx2")))
+void gfx_keyed_row_avx2(uint8_t *dst, const uint8_t *src, uint32_t pixel_count)
+{
+    const __m256i key_max = _mm256_set1_epi8(GFX_KEY_SUM_MAX);
+    uint32_t i = 0;
+
+    for (; i + 32 <= pixel_count; i += 32)
+    {
+        const uint8_t *s = src + (i * 3);
+        uint8_t *d = dst + (i * 3);
+        __m256i s_vec[4];
+        __m256i prev_keyed = _mm256_setzero_si256();
+
+        for (uint8_t r = 0; r < 3; r++) s_vec[r] = _mm256_loadu_si256((const __m256i *)(s + (r * 32)));
+        s_vec[3] = _mm256_setzero_si256();
+
+        for (uint8_t r = 0; r < 3; r++)
+        {
+            /// byte shifts across the 128-bit lanes align against [this high lane, neighbour low lane]
+            __m256i next_carry = _mm256_permute2x128_si256(s_vec[r], s_vec[r+1], 0x21);
+            __m256i next_1 = _mm256_alignr_epi8(next_carry, s_vec[r], 1);
+            __m256i next_2 = _mm256_alignr_epi8(next_carry, s_vec[r], 2);
+            __m256i sum = _mm256_adds_epu8(s_vec[r], _mm256_adds_epu8(next_1, next_2));
+            __m256i keyed = _mm256_cmpeq_epi8(_mm256_min_epu8(sum, key_max), sum);
+            keyed = _mm256_and_si256(keyed, _mm256_load_si256((const __m256i *)(texel_start_pattern_avx2 + (r * 32))));
+
+            __m256i prev_carry = _mm256_permute2x128_si256(prev_keyed, keyed, 0x21);
+            __m256i smeared = _mm256_or_si256(keyed,
+                              _mm256_or_si256(_mm256_alignr_epi8(keyed, prev_carry, 15), _mm256_alignr_epi8(keyed, prev_carry, 14)));
+            prev_keyed = keyed;
+
+            __m256i d_vec = _mm256_loadu_si256((const __m256i *)(d + (r * 32)));
+            _mm256_storeu_si256((__m256i *)(d + (r * 32)), _mm256_blendv_epi8(s_vec[r], d_vec, smeared));
+        }
+    }
+
+    /// the tail runs legacy SSE code, which stalls on dirty upper register halves
+    _mm256_zeroupper();
+    gfx_keyed_row_sse2(dst + (i * 3), src + (i * 3), pixel_count - i);
+}
+
+/**
+ * XRGB8888 texels fill whole 32-bit lanes, so the kernels mask out each lane's alpha byte,
+ * compare the lane against zero and select between destination and source lane by lane.
+ */
+
+void gfx_keyed_row_xrgb_sse2(uint8_t *dst, const uint8_t *src, uint32_t pixel_count)
+{
+    const __m128i alpha_mask = _mm_set1_epi32((int32_t)0xFF000000u);
+    uint32_t i = 0;
+
+    for (; i + 4 <= pixel_count; i += 4)
+    {
+        __m128i s_vec = _mm_loadu_si128((const __m128i *)(src + (i * 4)));
+        __m128i d_vec = _mm_loadu_si128((const __m128i *)(dst + (i * 4)));
+        __m128i keyed = _mm_cmpeq_epi32(_mm_and_si128(s_vec, alpha_mask), _mm_setzero_si128());
+
+        _mm_storeu_si128((__m128i *)(dst + (i * 4)), _mm_or_si128(_mm_and_si128(keyed, d_vec), _mm_andnot_si128(keyed, s_vec)));
+    }
+
+    gfx_keyed_row_xrgb_scalar(dst + (i * 4), src + (i * 4), pixel_count - i);
+}
+
+__attribute__((target("avx2")))
+void gfx_keyed_row_xrgb_avx2(uint8_t *dst, const uint8_t *src, uint32_t pixel_count)
+{
+    const __m256i alpha_mask = _mm256_set1_epi32((int32_t)0xFF000000u);
+    uint32_t i = 0;
+
+    for (; i + 8 <= pixel_count; i += 8)
+    {
+        __m256i s_vec = _mm256_loadu_si256((const __m256i *)(src + (i * 4)));
+        __m256i d_vec = _mm256_loadu_si256((const __m256i *)(dst + (i * 4)));
+        __m256i keyed = _mm256_cmpeq_epi32(_mm256_and_si256(s_vec, alpha_mask), _mm256_setzero_si256());
+
+        _mm256_storeu_si256((__m256i *)(dst + (i * 4)), _mm256_blendv_epi8(s_vec, d_vec, keyed));
+    }
+
+    /// the tail runs legacy SSE code, which stalls on dirty upper register halves
+    _mm256_zeroupper();
+    gfx_keyed_row_xrgb_sse2(dst + (i * 4), src + (i * 4), pixel_count - i);
+}
+
+#endif
+
+/**
+ * @brief Picks the widest keyed row kernels, RGB24 and XRGB8888 alike, the CPU supports.
+ *
+ * @retval The name of the selected instruction set, for logging.
+ */
+const char* gfx_kernels_init(void)
+{
+#ifdef GFX_KERNELS_X86
+    gfx_kernels_init_patterns();
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2"))
+    {
+        gfx_keyed_row = gfx_keyed_row_avx2;
+        gfx_keyed_row_xrgb = gfx_keyed_row_xrgb_avx2;
+        return "avx2";
+    }
+
+    gfx_keyed_row = gfx_keyed_row_sse2;
+    gfx_keyed_row_xrgb = gfx_keyed_row_xrgb_sse2;
+    return "sse2";
+#else
+    gfx_keyed_row = gfx_keyed_row_scalar;
+    gfx_keyed_row_xrgb = gfx_keyed_row_xrgb_scalar;
+    return "scalar";
+#endif
+}
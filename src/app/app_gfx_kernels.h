@@ -0,0 +1,30 @@
+#ifndef APP_GFX_KERNELS_H
+#define APP_GFX_KERNELS_H
+
+#include "app_common.h"
+
+/// RGB24 texels whose channels sum to no more than this are transparent, see texel_is_transparent()
+#define GFX_KEY_SUM_MAX (TEXEL_KEY_SUM_MAX)
+
+/**
+ * Copies the opaque texels of a row over the destination, testing transparency on the fly:
+ * the color key for RGB24 rows, the alpha byte for XRGB8888 rows.
+ */
+typedef void (*GfxKeyedRowFunc)(uint8_t *dst, const uint8_t *src, uint32_t pixel_count);
+
+extern GfxKeyedRowFunc gfx_keyed_row;
+extern GfxKeyedRowFunc gfx_keyed_row_xrgb;
+
+const char* gfx_kernels_init(void);
+void gfx_keyed_row_scalar(uint8_t *dst, const uint8_t *src, uint32_t pixel_count);
+void gfx_keyed_row_xrgb_scalar(uint8_t *dst, const uint8_t *src, uint32_t pixel_count);
+
+#if defined(__x86_64__)
+#define GFX_KERNELS_X86
+void gfx_keyed_row_sse2(uint8_t *dst, const uint8_t *src, uint32_t pixel_count);
+void gfx_keyed_row_avx2(uint8_t *dst, const uint8_t *src, uint32_t pixel_count);
+void gfx_keyed_row_xrgb_sse2(uint8_t *dst, const uint8_t *src, uint32_t pixel_count);
+void gfx_keyed_row_xrgb_avx2(uint8_t *dst, const uint8_t *src, uint32_t pixel_count);
+#endif
+
+#endif
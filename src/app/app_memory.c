@@ -1,17 +1,47 @@
 #include "app_memory.h"
+#include "app_gfx.h"
 
-UniformRing_t *input_buffer = NULL;
+Ring_InputEvent_t *input_buffer = NULL;
 Texture_t *gfx_buffer = NULL;
-UniformRing_t *audio_buffer = NULL;
+GfxDirtyList_t *gfx_dirty = NULL;
+RenderCommandList_t *gfx_commands = NULL;
+SpscRing_t *audio_buffer = NULL;
 
 AppEphemeralState_t *ephemerals = NULL;
 AppSerializableState_t *serializables = NULL;
 
+#define APP_ASSET_JOBS_MAX (APP_TEXTURES_MAX_COUNT > APP_SOUNDS_MAX_COUNT ? APP_TEXTURES_MAX_COUNT : APP_SOUNDS_MAX_COUNT)
+
+/// one listed asset, decoded by a worker into its own slot of the asset arena's free space
+typedef struct AppAssetJob
+{
+    char *name;
+    Arena_t slot;
+    bool loaded;
+    /// where the texture's compiled runs start within the slot, 0 if it has none
+    size_t runs_offset;
+} AppAssetJob_t;
+
+/// the assets of one list file, see load_listed_assets()
+typedef struct AppAssetBatch
+{
+    bool is_sound;
+    uint32_t count;
+    AppAssetJob_t jobs[APP_ASSET_JOBS_MAX];
+} AppAssetBatch_t;
+
 size_t load_texture_to_memory(char *name)
 {
-    size_t index = ephemerals->bump_used;
-    size_t remaining = sizeof(ephemerals->bump_buffer) - index;
-    Texture_t *texture_ptr = (Texture_t *)(ephemerals->bump_buffer+index);
+    size_t remaining = 0;
+    Texture_t *texture_ptr = (Texture_t *)arena_next(&ephemerals->assets_arena, COMMON_SIMD_ALIGNMENT, &remaining);
+
+    if (texture_ptr == NULL)
+    {
+        platform->debug_log("Cannot load texture: asset arena exhausted.");
+        return -1;
+    }
+
+    size_t index = (uint8_t *)texture_ptr - ephemerals->bump_buffer;
 
     snprintf(ephemerals->debug_buff, sizeof(ephemerals->debug_buff),
             "Loading texture '%s' to scratch memory at offset %ld, address %p.",
@@ -23,7 +53,11 @@ size_t load_texture_to_memory(char *name)
     if (!success) return -1;
 
     size_t size = sizeof(Texture_t) + (texture_ptr->height * texture_ptr->width * texture_ptr->pixel_size_bytes);
-    ephemerals->bump_used += size;
+    arena_alloc(&ephemerals->assets_arena, size, COMMON_SIMD_ALIGNMENT);
+
+    /// without runs, the texture is drawn texel by texel
+    SpriteRuns_t *runs_ptr = gfx_compile_texture_runs(texture_ptr, &ephemerals->assets_arena);
+    ephemerals->texture_run_offsets[ephemerals->textures_count] = runs_ptr != NULL ? (uint8_t *)runs_ptr - ephemerals->bump_buffer : 0;
 
     ephemerals->texture_offsets[ephemerals->textures_count] = index;
     ephemerals->textures_count++;
@@ -33,9 +67,16 @@ size_t load_texture_to_memory(char *name)
 
 size_t load_wav_to_memory(char *name)
 {
-    size_t index = ephemerals->bump_used;
-    size_t remaining = sizeof(ephemerals->bump_buffer) - index;
-    AudioClip_t *clip_ptr = (AudioClip_t *)(ephemerals->bump_buffer+index);
+    size_t remaining = 0;
+    AudioClip_t *clip_ptr = (AudioClip_t *)arena_next(&ephemerals->assets_arena, COMMON_SIMD_ALIGNMENT, &remaining);
+
+    if (clip_ptr == NULL)
+    {
+        platform->debug_log("Cannot load wav: asset arena exhausted.");
+        return -1;
+    }
+
+    size_t index = (uint8_t *)clip_ptr - ephemerals->bump_buffer;
 
     snprintf(ephemerals->debug_buff, sizeof(ephemerals->debug_buff), "Loading wav '%s' to scratch memory at offset %lu.", name, index);
     platform->debug_log(ephemerals->debug_buff);
@@ -67,7 +108,7 @@ size_t load_wav_to_memory(char *name)
     */
 
     size_t size = sizeof(AudioClip_t) + (sizeof(float) * clip_ptr->num_samples);
-    ephemerals->bump_used += size;
+    arena_alloc(&ephemerals->assets_arena, size, COMMON_SIMD_ALIGNMENT);
     
     ephemerals->sound_offsets[ephemerals->sounds_count] = index;
     ephemerals->sounds_count++;
@@ -75,6 +116,146 @@ size_t load_wav_to_memory(char *name)
     return index;
 }
 
+/**
+ * @brief Decodes one listed asset at the start of its slot, followed by a texture's compiled runs,
+ * laid out as load_texture_to_memory() and load_wav_to_memory() would lay them out in the arena.
+ * Must match prototype @ref WorkerJobFunc.
+ */
+static void load_asset_job(void *context, uint32_t job_idx)
+{
+    const AppAssetBatch_t *batch = (const AppAssetBatch_t *)context;
+    AppAssetJob_t *job = (AppAssetJob_t *)&batch->jobs[job_idx];
+    size_t remaining = 0;
+    void *dest = arena_next(&job->slot, COMMON_SIMD_ALIGNMENT, &remaining);
+
+    if (dest == NULL) return;
+
+    if (batch->is_sound)
+    {
+        AudioClip_t *clip_ptr = (AudioClip_t *)dest;
+        job->loaded = platform->audio_load_wav(job->name, clip_ptr, remaining);
+
+        if (job->loaded) arena_alloc(&job->slot, sizeof(AudioClip_t) + (sizeof(float) * clip_ptr->num_samples), COMMON_SIMD_ALIGNMENT);
+        return;
+    }
+
+    Texture_t *texture_ptr = (Texture_t *)dest;
+    job->loaded = platform->gfx_load_texture(job->name, texture_ptr, remaining);
+
+    if (!job->loaded) return;
+
+    arena_alloc(&job->slot, sizeof(Texture_t) + (texture_ptr->height * texture_ptr->width * texture_ptr->pixel_size_bytes), COMMON_SIMD_ALIGNMENT);
+
+    SpriteRuns_t *runs_ptr = gfx_compile_texture_runs(texture_ptr, &job->slot);
+    job->runs_offset = runs_ptr != NULL ? (uint8_t *)runs_ptr - job->slot.base : 0;
+}
+
+/**
+ * @brief Moves a decoded asset down from its slot to the asset arena's next free place, and lists it.
+ * Slots are at least as large as anything committed before them, so that place is never above the slot.
+ */
+static void commit_asset_job(const AppAssetBatch_t *batch, const AppAssetJob_t *job)
+{
+    uint8_t *previous_end = ephemerals->assets_arena.base + ephemerals->assets_arena.used;
+    uint8_t *dest = (uint8_t *)arena_alloc(&ephemerals->assets_arena, job->slot.used, COMMON_SIMD_ALIGNMENT);
+    memmove(dest, job->slot.base, job->slot.used);
+
+    /// the alignment padding may hold what was staged there, a serial load leaves it as it was
+    bzero(previous_end, dest - previous_end);
+
+    size_t index = dest - ephemerals->bump_buffer;
+
+    if (batch->is_sound)
+    {
+        ephemerals->sound_offsets[ephemerals->sounds_count] = index;
+        ephemerals->sounds_count++;
+        return;
+    }
+
+    ephemerals->texture_run_offsets[ephemerals->textures_count] = job->runs_offset > 0 ? index + job->runs_offset : 0;
+    ephemerals->texture_offsets[ephemerals->textures_count] = index;
+    ephemerals->textures_count++;
+}
+
+/**
+ * @brief Loads every asset a list file names, one per line, in listed order.
+ *
+ * @details
+ * With APP_ASSETS_LOAD_PARALLEL, the assets are first decoded on the worker pool, each into an equal share
+ * of the asset arena's free space, then committed one by one in listed order, ending up at the indices
+ * and offsets a serial load would have given them. From the first asset that failed to load on,
+ * the rest are loaded serially, so that a failure too leaves the indices as a serial load would.
+ */
+static void load_listed_assets(const char *list_name, bool is_sound)
+{
+    bzero(ephemerals->scratch, APP_SCRATCH_SIZE);
+    size_t txt_len = platform->storage_load_text(list_name, (char *)ephemerals->scratch, APP_SCRATCH_SIZE);
+
+    if (txt_len == 0) return;
+
+    AppAssetBatch_t batch = { .is_sound = is_sound, .count = 0 };
+    uint32_t count_max = is_sound ? APP_SOUNDS_MAX_COUNT : APP_TEXTURES_MAX_COUNT;
+
+    if (is_sound) ephemerals->sounds_count = 0;
+    else ephemerals->textures_count = 0;
+
+    char *current_line = (char *)ephemerals->scratch;
+    char *next_line = NULL;
+
+    while (current_line != NULL && batch.count < count_max)
+    {
+        next_line = strchr(current_line, '\n');
+        if (next_line) *next_line = '\0';
+
+        if (strlen(current_line) > 5)
+        {
+            batch.jobs[batch.count].name = current_line;
+            batch.count++;
+        }
+
+        current_line = next_line ? next_line + 1 : NULL;
+    }
+
+    uint32_t committed = 0;
+    size_t remaining = 0;
+    uint8_t *free_start = (uint8_t *)arena_next(&ephemerals->assets_arena, COMMON_SIMD_ALIGNMENT, &remaining);
+    size_t slot_size = batch.count > 0 ? (remaining / batch.count) & ~((size_t)COMMON_SIMD_ALIGNMENT - 1) : 0;
+
+    if (APP_ASSETS_LOAD_PARALLEL && free_start != NULL && slot_size > 0)
+    {
+        for (uint32_t i = 0; i < batch.count; i++)
+        {
+            batch.jobs[i].loaded = false;
+            batch.jobs[i].runs_offset = 0;
+            arena_init(&batch.jobs[i].slot, free_start + (i * slot_size), slot_size);
+        }
+
+        platform->workers_run(load_asset_job, &batch, batch.count);
+
+        while (committed < batch.count && batch.jobs[committed].loaded)
+        {
+            commit_asset_job(&batch, &batch.jobs[committed]);
+            committed++;
+        }
+
+        /// clear what is left of the staged assets past the committed ones
+        uint8_t *committed_end = ephemerals->assets_arena.base + ephemerals->assets_arena.used;
+
+        for (uint32_t i = 0; i < batch.count; i++)
+        {
+            uint8_t *staged_start = batch.jobs[i].slot.base > committed_end ? batch.jobs[i].slot.base : committed_end;
+            uint8_t *staged_end = batch.jobs[i].slot.base + batch.jobs[i].slot.high_water;
+            if (staged_start < staged_end) bzero(staged_start, staged_end - staged_start);
+        }
+    }
+
+    for (uint32_t i = committed; i < batch.count; i++)
+    {
+        if (is_sound) load_wav_to_memory(batch.jobs[i].name);
+        else load_texture_to_memory(batch.jobs[i].name);
+    }
+}
+
 void load_definitions_all(void)
 {
     static const char *filename = "definitions.soft";
@@ -209,63 +390,36 @@ void load_definitions_all(void)
 void load_ephemerals(void)
 {
     platform->debug_log("Initializing app ephemeral state.");
-    ephemerals->bump_used = 0;
-
-    /// load all textures according to file
-    size_t txt_len = 0;
+    arena_init(&ephemerals->assets_arena, ephemerals->bump_buffer, sizeof(ephemerals->bump_buffer));
 
-    bzero(ephemerals->scratch, APP_SCRATCH_SIZE);
-    txt_len = platform->storage_load_text("textures.soft", (char *)ephemerals->scratch, APP_SCRATCH_SIZE);
-
-    if (txt_len > 0)
-    {
-        ephemerals->textures_count = 0;
-
-        char *current_line = (char *)ephemerals->scratch;
-        char *next_line = NULL;
+    /// load all textures and sounds according to their files
+    int64_t load_start_us = platform->time_get_monotonic_us();
 
-        while (current_line != NULL && ephemerals->textures_count < APP_TEXTURES_MAX_COUNT)
-        {
-            next_line = strchr(current_line, '\n');
-            if (next_line) *next_line = '\0';
-            
-            if (strlen(current_line) > 5)
-            {
-                load_texture_to_memory(current_line);
-            }
+    load_listed_assets("textures.soft", false);
+    load_listed_assets("sounds.soft", true);
 
-            //if (next_line) *next_line = '\n';
-            current_line = next_line ? next_line + 1 : NULL;
-        }
-    }
+    snprintf(ephemerals->debug_buff, sizeof(ephemerals->debug_buff),
+            "Loaded %u textures and %u sounds in %ld us, %s.", ephemerals->textures_count, ephemerals->sounds_count,
+            platform->time_get_monotonic_us() - load_start_us, APP_ASSETS_LOAD_PARALLEL ? "decoded in parallel" : "one after another");
+    platform->debug_log(ephemerals->debug_buff);
 
-    /// load all sounds according to file
-    bzero(ephemerals->scratch, APP_SCRATCH_SIZE);
-    txt_len = platform->storage_load_text("sounds.soft", (char *)ephemerals->scratch, APP_SCRATCH_SIZE);
+    /// load all definitions according to file
+    load_definitions_all();
 
-    if (txt_len > 0)
+    /// whatever the scenes need is carved out after the assets
+    if (!arena_init_sub(&ephemerals->assets_arena, &ephemerals->scene_arena, APP_SCENE_ARENA_SIZE, COMMON_SIMD_ALIGNMENT))
     {
-        ephemerals->sounds_count = 0;
-
-        char *current_line = (char *)ephemerals->scratch;
-        char *next_line = NULL;
-
-        while (current_line != NULL && ephemerals->textures_count < APP_SOUNDS_MAX_COUNT)
-        {
-            next_line = strchr(current_line, '\n');
-            if (next_line) *next_line = '\0';
-            
-            if (strlen(current_line) > 5)
-            {
-                load_wav_to_memory(current_line);
-            }
-
-            current_line = next_line ? next_line + 1 : NULL;
-        }
+        platform->debug_log("Could not allocate the scene arena: asset arena exhausted.");
     }
 
-    /// load all definitions according to file
-    load_definitions_all();
+    snprintf(ephemerals->debug_buff, sizeof(ephemerals->debug_buff),
+            "Asset arena: %lu of %lu bytes used, scene arena: %lu bytes.",
+            ephemerals->assets_arena.high_water, ephemerals->assets_arena.capacity, ephemerals->scene_arena.capacity);
+    platform->debug_log(ephemerals->debug_buff);
+
+    /// textures may have changed under every entity, and the static cache went with the old scene arena
+    gfx_release_static_cache();
+    gfx_mark_all_dirty();
 }
 
 int32_t global_definition_get_idx_by_name(char *name)
@@ -329,3 +483,146 @@ int32_t definition_clone_to_local(int32_t src_idx, bool src_is_local, char *clon
 
     return dst_idx;
 }
+
+static bool state_pack_write(uint8_t *dest, size_t max_len, size_t *cursor, const void *src, size_t len)
+{
+    if (*cursor + len > max_len) return false;
+    memcpy(dest + *cursor, src, len);
+    *cursor += len;
+    return true;
+}
+
+static bool state_pack_read(const uint8_t *src, size_t len, size_t *cursor, void *dest, size_t dest_len)
+{
+    if (*cursor + dest_len > len) return false;
+    if (dest != NULL) memcpy(dest, src + *cursor, dest_len);
+    *cursor += dest_len;
+    return true;
+}
+
+/**
+ * @brief Packs the serializable state into a compact form holding only what is in use.
+ *
+ * @details
+ * Layout: a version and the size of AppSerializableState_t (so a changed layout is rejected),
+ * the state fields preceding the scenes, the loaded scene count, and for each loaded scene
+ * its index and counts followed by its live entities and local definitions.
+ * Unloaded scene slots and unused entity and definition slots are implied to be zeroed.
+ *
+ * @retval The packed size, or 0 if it would exceed 'max_len'.
+ */
+size_t state_serialize(void *dest, size_t max_len)
+{
+    uint8_t *out = (uint8_t *)dest;
+    size_t cursor = 0;
+    uint32_t version = APP_STATE_PACK_VERSION;
+    uint32_t state_size = sizeof(AppSerializableState_t);
+    uint8_t loaded_count = 0;
+
+    for (uint8_t i = 0; i < APP_STATE_MAX_SCENES; i++)
+    {
+        if (serializables->scenes[i].loaded) loaded_count++;
+    }
+
+    bool ok = state_pack_write(out, max_len, &cursor, &version, sizeof(version))
+        && state_pack_write(out, max_len, &cursor, &state_size, sizeof(state_size))
+        && state_pack_write(out, max_len, &cursor, serializables, offsetof(AppSerializableState_t, scenes))
+        && state_pack_write(out, max_len, &cursor, &loaded_count, sizeof(loaded_count));
+
+    for (uint8_t i = 0; ok && i < APP_STATE_MAX_SCENES; i++)
+    {
+        Scene_t *scene = &serializables->scenes[i];
+
+        if (!scene->loaded) continue;
+
+        ok = state_pack_write(out, max_len, &cursor, &i, sizeof(i))
+          && state_pack_write(out, max_len, &cursor, &scene->entity_count, sizeof(scene->entity_count))
+          && state_pack_write(out, max_len, &cursor, &scene->definitions_count, sizeof(scene->definitions_count))
+          && state_pack_write(out, max_len, &cursor, scene->entities, scene->entity_count * sizeof(Entity_t))
+          && state_pack_write(out, max_len, &cursor, scene->definitions, scene->definitions_count * sizeof(EntityDefinition_t))
+          && state_pack_write(out, max_len, &cursor, scene->sprites, scene->definitions_count * sizeof(Sprite_t))
+          && state_pack_write(out, max_len, &cursor, scene->colliders, scene->definitions_count * sizeof(Collider_t))
+          && state_pack_write(out, max_len, &cursor, scene->sound_emitters, scene->definitions_count * sizeof(SoundEmitter_t));
+    }
+
+    return ok ? cursor : 0;
+}
+
+/**
+ * @brief Walks packed state, validating it, and writes it to the live state if 'apply' is set.
+ * The state is only touched once a validating pass succeeded, so a bad pack leaves it intact.
+ */
+static bool state_deserialize_pass(const uint8_t *src, size_t len, bool apply)
+{
+    size_t cursor = 0;
+    uint32_t version = 0;
+    uint32_t state_size = 0;
+    uint8_t loaded_count = 0;
+
+    if (!state_pack_read(src, len, &cursor, &version, sizeof(version))
+        || !state_pack_read(src, len, &cursor, &state_size, sizeof(state_size))
+        || version != APP_STATE_PACK_VERSION || state_size != sizeof(AppSerializableState_t))
+    {
+        return false;
+    }
+
+    if (apply) explicit_bzero(serializables, sizeof(*serializables));
+
+    if (!state_pack_read(src, len, &cursor, apply ? serializables : NULL, offsetof(AppSerializableState_t, scenes))
+        || !state_pack_read(src, len, &cursor, &loaded_count, sizeof(loaded_count))
+        || loaded_count > APP_STATE_MAX_SCENES)
+    {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < loaded_count; i++)
+    {
+        uint8_t scene_idx = 0;
+        uint16_t entity_count = 0;
+        uint16_t definitions_count = 0;
+
+        if (!state_pack_read(src, len, &cursor, &scene_idx, sizeof(scene_idx))
+            || !state_pack_read(src, len, &cursor, &entity_count, sizeof(entity_count))
+            || !state_pack_read(src, len, &cursor, &definitions_count, sizeof(definitions_count))
+            || scene_idx >= APP_STATE_MAX_SCENES
+            || entity_count > SCENE_ENTITIES_MAX_COUNT
+            || definitions_count > SCENE_ENTITY_DEFS_MAX_COUNT)
+        {
+            return false;
+        }
+
+        Scene_t *scene = apply ? &serializables->scenes[scene_idx] : NULL;
+
+        if (!state_pack_read(src, len, &cursor, apply ? scene->entities : NULL, entity_count * sizeof(Entity_t))
+            || !state_pack_read(src, len, &cursor, apply ? scene->definitions : NULL, definitions_count * sizeof(EntityDefinition_t))
+            || !state_pack_read(src, len, &cursor, apply ? scene->sprites : NULL, definitions_count * sizeof(Sprite_t))
+            || !state_pack_read(src, len, &cursor, apply ? scene->colliders : NULL, definitions_count * sizeof(Collider_t))
+            || !state_pack_read(src, len, &cursor, apply ? scene->sound_emitters : NULL, definitions_count * sizeof(SoundEmitter_t)))
+        {
+            return false;
+        }
+
+        if (apply)
+        {
+            scene->loaded = true;
+            scene->entity_count = entity_count;
+            scene->definitions_count = definitions_count;
+        }
+    }
+
+    return cursor == len;
+}
+
+/**
+ * @brief Replaces the serializable state with packed state produced by state_serialize().
+ *
+ * @retval false if the packed state is malformed or from another layout, in which case the state is unchanged.
+ */
+bool state_deserialize(const void *src, size_t len)
+{
+    const uint8_t *in = (const uint8_t *)src;
+
+    if (!state_deserialize_pass(in, len, false)) return false;
+
+    return state_deserialize_pass(in, len, true);
+}
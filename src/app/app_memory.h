@@ -7,15 +7,95 @@
 #include "app_entity.h"
 
 #define APP_BUMP_SIZE (1024*2048)
+#define APP_SCENE_ARENA_SIZE (1024*1536)
 #define APP_SCRATCH_SIZE (4096)
 
 #define APP_TEXTURES_MAX_COUNT (64)
 #define APP_SOUNDS_MAX_COUNT (64)
+/// listed assets are decoded on the worker pool and committed in listed order, false loads them one after another
+#define APP_ASSETS_LOAD_PARALLEL (true)
 
 #define APP_LAYER_COUNT (6)
+/// layers below this hold scenery that never moves, pre-rendered once per scene into the static cache
+#define APP_STATIC_LAYER_COUNT (1)
 #define APP_ENTITY_DEFS_MAX_COUNT (128)
 
 #define APP_STATE_MAX_SCENES (16)
+/// bump whenever AppSerializableState_t's layout changes; packs carry it, and so does the state itself,
+/// so that mapped and raw states from another layout are caught as well
+#define APP_STATE_PACK_VERSION (2)
+
+#define APP_REWIND_FRAMES (1024)
+#define APP_REWIND_BYTES (1024*256)
+#define APP_REWIND_REPORT_FRAMES (256)
+
+#define APP_SPATIAL_CELL_PX (64)
+/// cells per side of the grid, which wraps around every APP_SPATIAL_GRID_DIM cells
+#define APP_SPATIAL_GRID_DIM (32)
+#define APP_SPATIAL_NONE (0xFFFF)
+
+typedef struct AppSerializableState
+{
+    /// APP_STATE_PACK_VERSION of the layout the state was initialized with
+    uint32_t layout_version;
+    bool initialized;
+    int32_t controller_mapping[APP_CONTROL_COUNT];
+    uint16_t mov_speed;
+    uint16_t controlled_entity_idx;
+    uint16_t focal_entity_idx;
+    uint8_t current_scene_index;
+    uint8_t scene_count;
+    Scene_t scenes[APP_STATE_MAX_SCENES];
+} AppSerializableState_t;
+
+/// a delta between consecutive recorded states, held in AppRewindState_t.deltas
+typedef struct AppRewindFrame
+{
+    uint32_t offset;
+    uint32_t len;
+} AppRewindFrame_t;
+
+/**
+ * Recent history of the serializable state, as XOR deltas between consecutive changed frames.
+ * 'frames' is a ring of up to APP_REWIND_FRAMES entries, oldest at 'frame_head',
+ * whose deltas are laid out in 'deltas' as a circular log, overwriting the oldest when full.
+ */
+typedef struct AppRewindState
+{
+    uint32_t frame_head;
+    uint32_t frame_count;
+    /// how many of the newest frames are currently undone
+    uint32_t cursor;
+    uint32_t write_offset;
+
+    /// cost tracking, reported every APP_REWIND_REPORT_FRAMES recorded frames
+    uint32_t report_frames;
+    size_t report_bytes;
+    int64_t report_us;
+
+    AppRewindFrame_t frames[APP_REWIND_FRAMES];
+    /// the state as of the newest frame, or as rewound to
+    AppSerializableState_t previous;
+    uint8_t deltas[APP_REWIND_BYTES];
+} AppRewindState_t;
+
+/**
+ * Uniform grid over the world-space sprite bounds of the current scene's entities.
+ * Each entity is listed only in the cell holding its top-left corner,
+ * so queries widen their range by the largest indexed sprite instead of entities spanning cells.
+ * Coordinates wrap around the grid, and query results are filtered by an exact rectangle test.
+ */
+typedef struct AppSpatialIndex
+{
+    uint16_t max_width;
+    uint16_t max_height;
+    uint16_t cell_heads[APP_SPATIAL_GRID_DIM * APP_SPATIAL_GRID_DIM];
+    /// per entity: its cell list links and cell, APP_SPATIAL_NONE if not indexed
+    uint16_t next[SCENE_ENTITIES_MAX_COUNT];
+    uint16_t prev[SCENE_ENTITIES_MAX_COUNT];
+    uint16_t cell[SCENE_ENTITIES_MAX_COUNT];
+    GfxRect_t rects[SCENE_ENTITIES_MAX_COUNT];
+} AppSpatialIndex_t;
 
 typedef struct AppEphemeralState
 {
@@ -35,29 +115,54 @@ typedef struct AppEphemeralState
 
     uint16_t textures_count;
     size_t texture_offsets[APP_TEXTURES_MAX_COUNT];
+    /// compiled SpriteRuns_t of each texture, 0 if it has none
+    size_t texture_run_offsets[APP_TEXTURES_MAX_COUNT];
 
     int32_t entities_draw_order_layer_offsets[APP_LAYER_COUNT];
     uint16_t entities_draw_order[SCENE_ENTITIES_MAX_COUNT];
 
-    size_t bump_used;
+    AppRewindState_t rewind;
+
+    AppSpatialIndex_t spatial;
+    /// each entity's position in entities_draw_order, refreshed every frame
+    uint16_t entities_draw_rank[SCENE_ENTITIES_MAX_COUNT];
+
+    /// what was last drawn, compared every frame to find the regions that need redrawing
+    bool gfx_redraw_all;
+    uint8_t drawn_scene_index;
+    uint16_t drawn_entity_count;
+    int16_t drawn_origin_x;
+    int16_t drawn_origin_y;
+    GfxRect_t drawn_rects[SCENE_ENTITIES_MAX_COUNT];
+    uint16_t drawn_textures[SCENE_ENTITIES_MAX_COUNT];
+
+    /// the static layers pre-rendered into a Texture_t in scene_arena, 0 if there is none
+    size_t static_cache_offset;
+    size_t static_cache_capacity;
+    /// whether static_cache_signature describes the current scene, and whether the cache can be drawn
+    bool static_cache_current;
+    bool static_cache_valid;
+    uint64_t static_cache_signature;
+    /// the cache's top-left corner, relative to where the world origin is on screen
+    int32_t static_cache_x;
+    int32_t static_cache_y;
+
+    /// draw cost tracking, reported every APP_GFX_REPORT_FRAMES frames
+    uint32_t draw_report_frames;
+    int64_t draw_report_us;
+
+    /// asset memory, carved out of bump_buffer; reset whenever the ephemerals are reloaded
+    Arena_t assets_arena;
+    /// per-scene memory, a sub-arena of assets_arena; reset whenever the current scene changes
+    Arena_t scene_arena;
     uint8_t bump_buffer[APP_BUMP_SIZE];
 } AppEphemeralState_t;
 
-typedef struct AppSerializableState
-{
-    bool initialized;
-    int32_t controller_mapping[APP_CONTROL_COUNT];
-    uint16_t mov_speed;
-    uint16_t controlled_entity_idx;
-    uint16_t focal_entity_idx;
-    uint8_t current_scene_index;
-    uint8_t scene_count;
-    Scene_t scenes[APP_STATE_MAX_SCENES];
-} AppSerializableState_t;
-
-extern UniformRing_t *input_buffer;
+extern Ring_InputEvent_t *input_buffer;
 extern Texture_t *gfx_buffer;
-extern UniformRing_t *audio_buffer;
+extern GfxDirtyList_t *gfx_dirty;
+extern RenderCommandList_t *gfx_commands;
+extern SpscRing_t *audio_buffer;
 
 extern AppEphemeralState_t *ephemerals;
 extern AppSerializableState_t *serializables;
@@ -73,4 +178,7 @@ int32_t global_definition_get_idx_by_name(char *name);
 int32_t local_definition_get_idx_by_name(char *name);
 int32_t definition_clone_to_local(int32_t src_idx, bool src_is_local, char *clone_name);
 
+size_t state_serialize(void *dest, size_t max_len);
+bool state_deserialize(const void *src, size_t len);
+
 #endif
@@ -0,0 +1,210 @@
+#include "app_rewind.h"
+#include "app_memory.h"
+#include "app_entity.h"
+#include "common_codec.h"
+
+static AppRewindFrame_t* rewind_get_frame(AppRewindState_t *rewind, uint32_t age_idx)
+{
+    return &rewind->frames[(rewind->frame_head + age_idx) % APP_REWIND_FRAMES];
+}
+
+static void rewind_drop_oldest(AppRewindState_t *rewind)
+{
+    rewind->frame_head = (rewind->frame_head + 1) % APP_REWIND_FRAMES;
+    rewind->frame_count--;
+}
+
+/**
+ * @brief Drops the undone frames, once the state has diverged from the point it was rewound to.
+ */
+static void rewind_truncate(AppRewindState_t *rewind)
+{
+    if (rewind->cursor == 0) return;
+
+    rewind->frame_count -= rewind->cursor;
+    rewind->cursor = 0;
+
+    if (rewind->frame_count > 0)
+    {
+        AppRewindFrame_t *newest = rewind_get_frame(rewind, rewind->frame_count - 1);
+        rewind->write_offset = newest->offset + newest->len;
+    }
+    else
+    {
+        rewind->write_offset = 0;
+    }
+}
+
+/**
+ * @brief Applies a frame's delta to both the live state and the rewind baseline, in either direction.
+ */
+static bool rewind_apply_frame(AppRewindState_t *rewind, AppRewindFrame_t *frame)
+{
+    uint8_t *delta = rewind->deltas + frame->offset;
+
+    if (!codec_delta_apply(delta, frame->len, serializables, sizeof(*serializables))
+        || !codec_delta_apply(delta, frame->len, &rewind->previous, sizeof(rewind->previous)))
+    {
+        platform->debug_log("Corrupt rewind frame, history cleared.");
+        rewind_reset();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Clears the history and takes the current serializable state as the new baseline.
+ * Must be called whenever the state is replaced outside of the app loop.
+ */
+void rewind_reset(void)
+{
+    AppRewindState_t *rewind = &ephemerals->rewind;
+
+    rewind->frame_head = 0;
+    rewind->frame_count = 0;
+    rewind->cursor = 0;
+    rewind->write_offset = 0;
+    rewind->report_frames = 0;
+    rewind->report_bytes = 0;
+    rewind->report_us = 0;
+
+    memcpy(&rewind->previous, serializables, sizeof(*serializables));
+}
+
+/**
+ * @brief Records the change to the serializable state since the last call, if any, as a new frame.
+ *
+ * @details
+ * Called once per frame, after the state was updated. Frames without changes are not recorded,
+ * so the history spans as much play as the delta budget allows, however long the idle stretches.
+ * The delta is encoded straight into the circular log; when it does not fit before the end,
+ * the log wraps, and any oldest frames whose bytes were overwritten are dropped.
+ */
+void rewind_record(void)
+{
+    AppRewindState_t *rewind = &ephemerals->rewind;
+
+    if (memcmp(&rewind->previous, serializables, sizeof(*serializables)) == 0) return;
+
+    int64_t start_us = platform->time_get_monotonic_us();
+
+    rewind_truncate(rewind);
+
+    uint32_t offset = rewind->write_offset;
+    size_t delta_len = 0;
+    bool encoded = codec_delta_encode(&rewind->previous, serializables, sizeof(*serializables),
+                                      rewind->deltas + offset, APP_REWIND_BYTES - offset, &delta_len);
+
+    if (!encoded)
+    {
+        /// the frames ahead of the write offset are the oldest, and were partially overwritten
+        while (rewind->frame_count > 0 && rewind_get_frame(rewind, 0)->offset >= offset)
+        {
+            rewind_drop_oldest(rewind);
+        }
+
+        offset = 0;
+        encoded = codec_delta_encode(&rewind->previous, serializables, sizeof(*serializables),
+                                     rewind->deltas, APP_REWIND_BYTES, &delta_len);
+    }
+
+    if (!encoded)
+    {
+        platform->debug_log("State change too large for the rewind buffer, history cleared.");
+        rewind_reset();
+        return;
+    }
+
+    while (rewind->frame_count > 0)
+    {
+        AppRewindFrame_t *oldest = rewind_get_frame(rewind, 0);
+
+        if (rewind->frame_count < APP_REWIND_FRAMES
+            && (oldest->offset >= offset + delta_len || oldest->offset + oldest->len <= offset))
+        {
+            break;
+        }
+
+        rewind_drop_oldest(rewind);
+    }
+
+    AppRewindFrame_t *frame = rewind_get_frame(rewind, rewind->frame_count);
+    frame->offset = offset;
+    frame->len = delta_len;
+    rewind->frame_count++;
+    rewind->write_offset = offset + delta_len;
+
+    /// brings the baseline up to date by touching only the changed bytes
+    codec_delta_apply(rewind->deltas + offset, delta_len, &rewind->previous, sizeof(rewind->previous));
+
+    rewind->report_frames++;
+    rewind->report_bytes += delta_len;
+    rewind->report_us += platform->time_get_monotonic_us() - start_us;
+
+    if (rewind->report_frames >= APP_REWIND_REPORT_FRAMES)
+    {
+        snprintf(ephemerals->debug_buff, sizeof(ephemerals->debug_buff),
+                "Rewind: %u frames held, last %u averaged %lu delta bytes and %ld us each.",
+                rewind->frame_count, rewind->report_frames,
+                rewind->report_bytes / rewind->report_frames, rewind->report_us / rewind->report_frames);
+        platform->debug_log(ephemerals->debug_buff);
+
+        rewind->report_frames = 0;
+        rewind->report_bytes = 0;
+        rewind->report_us = 0;
+    }
+}
+
+/**
+ * @brief Undoes the newest frame not yet undone.
+ * Any unrecorded change is recorded first, so the live state always matches the baseline the deltas apply to.
+ */
+void rewind_step_back(void)
+{
+    AppRewindState_t *rewind = &ephemerals->rewind;
+
+    rewind_record();
+
+    if (rewind->cursor >= rewind->frame_count) return;
+
+    if (rewind_apply_frame(rewind, rewind_get_frame(rewind, rewind->frame_count - 1 - rewind->cursor)))
+    {
+        rewind->cursor++;
+        entities_initialize_draw_order();
+    }
+}
+
+/**
+ * @brief Redoes all undone frames, returning to the newest recorded state.
+ * Has no effect once the state has changed since rewinding, as that discards the undone frames.
+ */
+void rewind_restore(void)
+{
+    AppRewindState_t *rewind = &ephemerals->rewind;
+    uint32_t undone_count = rewind->cursor;
+
+    rewind_record();
+
+    while (rewind->cursor > 0)
+    {
+        if (!rewind_apply_frame(rewind, rewind_get_frame(rewind, rewind->frame_count - rewind->cursor))) return;
+        rewind->cursor--;
+    }
+
+    entities_initialize_draw_order();
+
+    snprintf(ephemerals->debug_buff, sizeof(ephemerals->debug_buff), "Restored %u rewound frames.", undone_count - rewind->cursor);
+    platform->debug_log(ephemerals->debug_buff);
+}
+
+/**
+ * @brief Logs how far back the state is rewound.
+ */
+void rewind_log_position(void)
+{
+    AppRewindState_t *rewind = &ephemerals->rewind;
+
+    snprintf(ephemerals->debug_buff, sizeof(ephemerals->debug_buff), "Rewound %u of %u frames.", rewind->cursor, rewind->frame_count);
+    platform->debug_log(ephemerals->debug_buff);
+}
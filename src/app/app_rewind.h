@@ -0,0 +1,12 @@
+#ifndef APP_REWIND_H
+#define APP_REWIND_H
+
+#include "app_common.h"
+
+void rewind_reset(void);
+void rewind_record(void);
+void rewind_step_back(void);
+void rewind_restore(void);
+void rewind_log_position(void);
+
+#endif
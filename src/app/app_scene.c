@@ -1,6 +1,7 @@
 #include "app_scene.h"
 #include "app_common.h"
 #include "app_memory.h"
+#include "app_gfx.h"
 
 void load_scene_by_path(char *path)
 {
@@ -120,6 +121,18 @@ void load_scene_by_path(char *path)
 
 void load_scene_by_index(uint8_t index)
 {
+    /// per-scene data belongs to whichever scene was current until now
+    if (ephemerals->scene_arena.high_water > 0)
+    {
+        snprintf(ephemerals->debug_buff, sizeof(ephemerals->debug_buff),
+                "Releasing scene arena, peak usage %lu of %lu bytes.",
+                ephemerals->scene_arena.high_water, ephemerals->scene_arena.capacity);
+        platform->debug_log(ephemerals->debug_buff);
+    }
+
+    arena_reset(&ephemerals->scene_arena);
+    gfx_release_static_cache();
+
     /// if scene was loaded before, simply set it to be the current scene
     if (serializables->scenes[index].loaded)
     {
@@ -0,0 +1,131 @@
+#include "app_spatial.h"
+#include "app_memory.h"
+
+/// floor division, so that negative world coordinates land in the cell to their left
+static int32_t spatial_cell_coord(int32_t px)
+{
+    return (px >= 0 ? px : px - (APP_SPATIAL_CELL_PX - 1)) / APP_SPATIAL_CELL_PX;
+}
+
+static uint16_t spatial_cell_idx(int32_t cell_x, int32_t cell_y)
+{
+    uint32_t wrapped_x = (uint32_t)cell_x & (APP_SPATIAL_GRID_DIM - 1);
+    uint32_t wrapped_y = (uint32_t)cell_y & (APP_SPATIAL_GRID_DIM - 1);
+    return wrapped_x + (wrapped_y * APP_SPATIAL_GRID_DIM);
+}
+
+static void spatial_unlink(AppSpatialIndex_t *spatial, uint16_t entity_idx)
+{
+    uint16_t cell = spatial->cell[entity_idx];
+
+    if (cell == APP_SPATIAL_NONE) return;
+
+    if (spatial->prev[entity_idx] != APP_SPATIAL_NONE) spatial->next[spatial->prev[entity_idx]] = spatial->next[entity_idx];
+    else spatial->cell_heads[cell] = spatial->next[entity_idx];
+
+    if (spatial->next[entity_idx] != APP_SPATIAL_NONE) spatial->prev[spatial->next[entity_idx]] = spatial->prev[entity_idx];
+
+    spatial->cell[entity_idx] = APP_SPATIAL_NONE;
+}
+
+/**
+ * @brief Empties the index. Must be called whenever the current scene changes.
+ */
+void spatial_reset(void)
+{
+    AppSpatialIndex_t *spatial = &ephemerals->spatial;
+
+    spatial->max_width = 0;
+    spatial->max_height = 0;
+
+    for (uint32_t i = 0; i < APP_SPATIAL_GRID_DIM * APP_SPATIAL_GRID_DIM; i++)
+    {
+        spatial->cell_heads[i] = APP_SPATIAL_NONE;
+    }
+
+    for (uint32_t i = 0; i < SCENE_ENTITIES_MAX_COUNT; i++)
+    {
+        spatial->cell[i] = APP_SPATIAL_NONE;
+    }
+}
+
+/**
+ * @brief Sets an entity's world-space sprite bounds, moving it between cells only if its corner changed cell.
+ * Returns right away if the entity is indexed with these bounds already.
+ * An empty rectangle removes the entity from the index.
+ */
+void spatial_update(uint16_t entity_idx, GfxRect_t rect)
+{
+    AppSpatialIndex_t *spatial = &ephemerals->spatial;
+
+    if (spatial->cell[entity_idx] != APP_SPATIAL_NONE && rect_equals(spatial->rects[entity_idx], rect)) return;
+
+    if (rect_is_empty(rect))
+    {
+        spatial_unlink(spatial, entity_idx);
+        return;
+    }
+
+    uint16_t cell = spatial_cell_idx(spatial_cell_coord(rect.x), spatial_cell_coord(rect.y));
+
+    spatial->rects[entity_idx] = rect;
+    if (rect.w > spatial->max_width) spatial->max_width = rect.w;
+    if (rect.h > spatial->max_height) spatial->max_height = rect.h;
+
+    if (spatial->cell[entity_idx] == cell) return;
+
+    spatial_unlink(spatial, entity_idx);
+
+    spatial->cell[entity_idx] = cell;
+    spatial->prev[entity_idx] = APP_SPATIAL_NONE;
+    spatial->next[entity_idx] = spatial->cell_heads[cell];
+
+    if (spatial->cell_heads[cell] != APP_SPATIAL_NONE) spatial->prev[spatial->cell_heads[cell]] = entity_idx;
+
+    spatial->cell_heads[cell] = entity_idx;
+}
+
+/**
+ * @brief Finds the indexed entities whose bounds overlap a world-space rectangle.
+ * Only the cells that may hold such an entity's corner are visited, so the cost follows
+ * the number of entities near the rectangle rather than the size of the scene.
+ *
+ * @retval The number of entity indices written to 'out', in no particular order.
+ */
+uint16_t spatial_query(GfxRect_t rect, uint16_t *out, uint16_t max_count)
+{
+    AppSpatialIndex_t *spatial = &ephemerals->spatial;
+    uint16_t count = 0;
+
+    if (rect_is_empty(rect)) return 0;
+
+    int32_t min_cell_x = spatial_cell_coord(rect.x - spatial->max_width + 1);
+    int32_t min_cell_y = spatial_cell_coord(rect.y - spatial->max_height + 1);
+    int32_t max_cell_x = spatial_cell_coord(rect.x + rect.w - 1);
+    int32_t max_cell_y = spatial_cell_coord(rect.y + rect.h - 1);
+
+    /// a range wider than the grid would visit wrapped cells twice
+    if (max_cell_x - min_cell_x >= APP_SPATIAL_GRID_DIM) max_cell_x = min_cell_x + APP_SPATIAL_GRID_DIM - 1;
+    if (max_cell_y - min_cell_y >= APP_SPATIAL_GRID_DIM) max_cell_y = min_cell_y + APP_SPATIAL_GRID_DIM - 1;
+
+    for (int32_t cell_y = min_cell_y; cell_y <= max_cell_y; cell_y++)
+    {
+        for (int32_t cell_x = min_cell_x; cell_x <= max_cell_x; cell_x++)
+        {
+            uint16_t entity_idx = spatial->cell_heads[spatial_cell_idx(cell_x, cell_y)];
+
+            while (entity_idx != APP_SPATIAL_NONE && count < max_count)
+            {
+                if (rect_overlaps(spatial->rects[entity_idx], rect))
+                {
+                    out[count] = entity_idx;
+                    count++;
+                }
+
+                entity_idx = spatial->next[entity_idx];
+            }
+        }
+    }
+
+    return count;
+}
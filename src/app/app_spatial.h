@@ -0,0 +1,10 @@
+#ifndef APP_SPATIAL_H
+#define APP_SPATIAL_H
+
+#include "app_common.h"
+
+void spatial_reset(void);
+void spatial_update(uint16_t entity_idx, GfxRect_t rect);
+uint16_t spatial_query(GfxRect_t rect, uint16_t *out, uint16_t max_count);
+
+#endif
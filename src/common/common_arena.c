@@ -0,0 +1,100 @@
+#include "common_arena.h"
+
+/**
+ * @brief Returns the offset into the arena at which an allocation with the given alignment would start.
+ * Alignment is applied to the actual address, so it holds regardless of how the backing buffer is aligned.
+ * The alignment must be a power of two.
+ */
+static size_t arena_aligned_offset(const Arena_t *arena, size_t alignment)
+{
+    uintptr_t address = (uintptr_t)(arena->base + arena->used);
+    uintptr_t aligned = (address + (alignment - 1)) & ~((uintptr_t)alignment - 1);
+    return arena->used + (aligned - address);
+}
+
+void arena_init(Arena_t *arena, void *buffer, size_t capacity)
+{
+    arena->base = (uint8_t *)buffer;
+    arena->capacity = capacity;
+    arena->used = 0;
+    arena->high_water = 0;
+}
+
+/**
+ * @brief Allocates 'capacity' bytes from a parent arena and initializes them as an independent child arena.
+ * Resetting the child does not affect the parent; resetting the parent past the child invalidates it.
+ *
+ * @retval false The parent could not fit the requested capacity; the child is left empty.
+ */
+bool arena_init_sub(Arena_t *parent, Arena_t *child, size_t capacity, size_t alignment)
+{
+    void *buffer = arena_alloc(parent, capacity, alignment);
+
+    arena_init(child, buffer, buffer == NULL ? 0 : capacity);
+
+    return buffer != NULL;
+}
+
+/**
+ * @brief Returns where the next allocation with the given alignment would be placed, without allocating.
+ *
+ * @details
+ * For producers that only learn the size after writing (e.g. asset decoders given a size limit):
+ * write at the returned address, then claim the written size with arena_alloc() at the same alignment,
+ * which is guaranteed to return the same address.
+ *
+ * @param [out] available_out If not NULL, receives the number of bytes available at the returned address.
+ *
+ * @retval NULL The arena is exhausted.
+ */
+void* arena_next(const Arena_t *arena, size_t alignment, size_t *available_out)
+{
+    size_t offset = arena_aligned_offset(arena, alignment);
+
+    if (offset >= arena->capacity)
+    {
+        if (available_out != NULL) *available_out = 0;
+        return NULL;
+    }
+
+    if (available_out != NULL) *available_out = arena->capacity - offset;
+    return arena->base + offset;
+}
+
+/**
+ * @brief Allocates 'size' bytes at the given power-of-two alignment. The memory is not cleared.
+ *
+ * @retval NULL The arena cannot fit the allocation; the arena is left unchanged.
+ */
+void* arena_alloc(Arena_t *arena, size_t size, size_t alignment)
+{
+    size_t offset = arena_aligned_offset(arena, alignment);
+
+    if (offset > arena->capacity || size > arena->capacity - offset) return NULL;
+
+    arena->used = offset + size;
+    if (arena->used > arena->high_water) arena->high_water = arena->used;
+
+    return arena->base + offset;
+}
+
+ArenaMark_t arena_get_mark(const Arena_t *arena)
+{
+    return arena->used;
+}
+
+/**
+ * @brief Releases every allocation made since the given mark was taken.
+ */
+void arena_reset_to_mark(Arena_t *arena, ArenaMark_t mark)
+{
+    if (mark < arena->used) arena->used = mark;
+}
+
+/**
+ * @brief Releases every allocation. The high-water mark is kept, to report peak usage across resets.
+ */
+void arena_reset(Arena_t *arena)
+{
+    arena->used = 0;
+}
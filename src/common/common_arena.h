@@ -0,0 +1,32 @@
+#ifndef COMMON_ARENA_H
+#define COMMON_ARENA_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct Arena Arena_t;
+typedef size_t ArenaMark_t;
+
+/**
+ * Linear allocator over a caller-provided buffer.
+ * Allocations are released all at once (arena_reset) or back to a saved mark (arena_reset_to_mark);
+ * a sub-arena carved out of a parent can be reset independently of it.
+ */
+struct Arena
+{
+    uint8_t *base;
+    size_t capacity;
+    size_t used;
+    size_t high_water;
+};
+
+void arena_init(Arena_t *arena, void *buffer, size_t capacity);
+bool arena_init_sub(Arena_t *parent, Arena_t *child, size_t capacity, size_t alignment);
+void* arena_next(const Arena_t *arena, size_t alignment, size_t *available_out);
+void* arena_alloc(Arena_t *arena, size_t size, size_t alignment);
+ArenaMark_t arena_get_mark(const Arena_t *arena);
+void arena_reset_to_mark(Arena_t *arena, ArenaMark_t mark);
+void arena_reset(Arena_t *arena);
+
+#endif
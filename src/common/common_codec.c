@@ -0,0 +1,347 @@
+#include "common_codec.h"
+#include <string.h>
+
+#define CODEC_CHECKSUM_SEED (0xcbf29ce484222325ull)
+#define CODEC_CHECKSUM_PRIME (0x100000001b3ull)
+
+/**
+ * @brief Returns a 64-bit FNV-1a style checksum of the given data.
+ * Consumes 8 bytes per step, so validating a few megabytes of state costs well under a millisecond.
+ * Intended for detecting torn or corrupted data, not for security.
+ */
+uint64_t codec_checksum(const void *data, size_t len)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+    uint64_t hash = CODEC_CHECKSUM_SEED ^ (uint64_t)len;
+    uint64_t word = 0;
+    size_t i = 0;
+
+    for (; i + sizeof(word) <= len; i += sizeof(word))
+    {
+        memcpy(&word, bytes+i, sizeof(word));
+        hash = (hash ^ word) * CODEC_CHECKSUM_PRIME;
+        hash ^= hash >> 29;
+    }
+
+    for (; i < len; i++)
+    {
+        hash = (hash ^ bytes[i]) * CODEC_CHECKSUM_PRIME;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Returns the worst-case encoded size of 'len' bytes, reached when nothing repeats.
+ */
+size_t codec_rle_bound(size_t len)
+{
+    return len + (len / CODEC_RLE_LITERAL_MAX) + 1;
+}
+
+/**
+ * @brief Run-length encodes 'len' bytes.
+ *
+ * @details
+ * The output is a sequence of tokens, each led by a control byte:
+ * below 0x80 it is followed by (control + 1) literal bytes,
+ * otherwise by a single byte repeated (control - 0x80 + CODEC_RLE_RUN_MIN) times.
+ * Cheap enough to run on the main loop for the sizes the app saves, and zero-filled
+ * padding and empty slots, which dominate serialized state, shrink ~65x.
+ *
+ * @retval The encoded size, or 0 if it would exceed 'dst_capacity'.
+ */
+size_t codec_rle_encode(const void *src, size_t len, void *dst, size_t dst_capacity)
+{
+    const uint8_t *in = (const uint8_t *)src;
+    uint8_t *out = (uint8_t *)dst;
+    size_t in_idx = 0;
+    size_t out_idx = 0;
+
+    while (in_idx < len)
+    {
+        size_t run = 1;
+
+        while (in_idx + run < len && run < CODEC_RLE_RUN_MAX && in[in_idx + run] == in[in_idx])
+        {
+            run++;
+        }
+
+        if (run >= CODEC_RLE_RUN_MIN)
+        {
+            if (out_idx + 2 > dst_capacity) return 0;
+            out[out_idx++] = (uint8_t)(0x80 | (run - CODEC_RLE_RUN_MIN));
+            out[out_idx++] = in[in_idx];
+            in_idx += run;
+            continue;
+        }
+
+        /// literals extend up to the next run worth encoding
+        size_t literal_start = in_idx;
+        size_t literal_len = 0;
+
+        while (in_idx < len && literal_len < CODEC_RLE_LITERAL_MAX)
+        {
+            if (in_idx + 2 < len && in[in_idx] == in[in_idx + 1] && in[in_idx] == in[in_idx + 2]) break;
+            in_idx++;
+            literal_len++;
+        }
+
+        if (out_idx + 1 + literal_len > dst_capacity) return 0;
+        out[out_idx++] = (uint8_t)(literal_len - 1);
+        memcpy(out + out_idx, in + literal_start, literal_len);
+        out_idx += literal_len;
+    }
+
+    return out_idx;
+}
+
+/**
+ * @brief Expands data encoded by codec_rle_encode().
+ *
+ * @retval The decoded size, or 0 if the input is malformed or would exceed 'dst_capacity'.
+ */
+size_t codec_rle_decode(const void *src, size_t len, void *dst, size_t dst_capacity)
+{
+    const uint8_t *in = (const uint8_t *)src;
+    uint8_t *out = (uint8_t *)dst;
+    size_t in_idx = 0;
+    size_t out_idx = 0;
+
+    while (in_idx < len)
+    {
+        uint8_t control = in[in_idx++];
+
+        if (control & 0x80)
+        {
+            size_t run = (size_t)(control & 0x7f) + CODEC_RLE_RUN_MIN;
+            if (in_idx >= len || out_idx + run > dst_capacity) return 0;
+            memset(out + out_idx, in[in_idx++], run);
+            out_idx += run;
+        }
+        else
+        {
+            size_t literal_len = (size_t)control + 1;
+            if (in_idx + literal_len > len || out_idx + literal_len > dst_capacity) return 0;
+            memcpy(out + out_idx, in + in_idx, literal_len);
+            in_idx += literal_len;
+            out_idx += literal_len;
+        }
+    }
+
+    return out_idx;
+}
+
+/**
+ * @brief Returns the worst-case size of codec_pack() output for 'raw_len' bytes.
+ */
+size_t codec_pack_bound(size_t raw_len)
+{
+    return sizeof(CodecPackHeader_t) + codec_rle_bound(raw_len);
+}
+
+/**
+ * @brief Compresses 'raw' behind a header carrying its size and checksum, for storage.
+ *
+ * @retval The total packed size, or 0 if it would exceed 'dst_capacity'.
+ */
+size_t codec_pack(const void *raw, size_t raw_len, void *dst, size_t dst_capacity)
+{
+    if (dst_capacity < sizeof(CodecPackHeader_t) || raw_len > UINT32_MAX) return 0;
+
+    uint8_t *out = (uint8_t *)dst;
+    size_t packed_len = codec_rle_encode(raw, raw_len, out + sizeof(CodecPackHeader_t), dst_capacity - sizeof(CodecPackHeader_t));
+
+    if (packed_len == 0 && raw_len > 0) return 0;
+
+    CodecPackHeader_t header =
+    {
+        .magic = CODEC_PACK_MAGIC,
+        .version = CODEC_PACK_VERSION,
+        .reserved = 0,
+        .raw_bytes = (uint32_t)raw_len,
+        .packed_bytes = (uint32_t)packed_len,
+        .checksum = codec_checksum(raw, raw_len),
+    };
+
+    memcpy(out, &header, sizeof(header));
+
+    return sizeof(header) + packed_len;
+}
+
+/**
+ * @brief Returns whether the data starts with a packed header of a supported version.
+ */
+bool codec_is_packed(const void *src, size_t len)
+{
+    CodecPackHeader_t header;
+
+    if (len < sizeof(header)) return false;
+
+    memcpy(&header, src, sizeof(header));
+    return header.magic == CODEC_PACK_MAGIC && header.version == CODEC_PACK_VERSION;
+}
+
+/**
+ * @brief Validates and expands codec_pack() output.
+ *
+ * @retval The raw size, or 0 if the data is truncated, malformed, corrupted or too large for 'raw_capacity'.
+ */
+size_t codec_unpack(const void *src, size_t len, void *raw, size_t raw_capacity)
+{
+    CodecPackHeader_t header;
+
+    if (!codec_is_packed(src, len)) return 0;
+
+    memcpy(&header, src, sizeof(header));
+
+    if (header.raw_bytes > raw_capacity || sizeof(header) + header.packed_bytes != len) return 0;
+
+    size_t raw_len = codec_rle_decode((const uint8_t *)src + sizeof(header), header.packed_bytes, raw, header.raw_bytes);
+
+    if (raw_len != header.raw_bytes || codec_checksum(raw, raw_len) != header.checksum) return 0;
+
+    return raw_len;
+}
+
+static bool codec_write_varint(uint8_t *out, size_t capacity, size_t *out_idx, size_t value)
+{
+    do
+    {
+        if (*out_idx >= capacity) return false;
+        out[(*out_idx)++] = (uint8_t)((value & 0x7f) | (value > 0x7f ? 0x80 : 0));
+        value >>= 7;
+    }
+    while (value > 0);
+
+    return true;
+}
+
+static bool codec_read_varint(const uint8_t *in, size_t len, size_t *in_idx, size_t *value)
+{
+    size_t result = 0;
+
+    for (uint8_t shift = 0; shift < 8 * sizeof(size_t); shift += 7)
+    {
+        if (*in_idx >= len) return false;
+
+        uint8_t byte = in[(*in_idx)++];
+        result |= (size_t)(byte & 0x7f) << shift;
+
+        if (!(byte & 0x80))
+        {
+            *value = result;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Encodes the difference between two equally sized buffers.
+ *
+ * @details
+ * The delta is a sequence of [varint skip][varint length][length XOR bytes] tokens,
+ * so unchanged stretches cost nothing but their skip, and an unchanged buffer encodes to nothing.
+ * Since XOR is its own inverse, the same delta turns 'prev' into 'cur' and 'cur' back into 'prev'.
+ * Unchanged stretches are scanned a word at a time.
+ *
+ * @retval false if the delta would exceed 'dst_capacity'.
+ */
+bool codec_delta_encode(const void *prev, const void *cur, size_t len, void *dst, size_t dst_capacity, size_t *delta_len)
+{
+    const uint8_t *a = (const uint8_t *)prev;
+    const uint8_t *b = (const uint8_t *)cur;
+    uint8_t *out = (uint8_t *)dst;
+    size_t out_idx = 0;
+    size_t idx = 0;
+
+    while (idx < len)
+    {
+        size_t skip_start = idx;
+        uint64_t word_a;
+        uint64_t word_b;
+
+        while (idx + sizeof(uint64_t) <= len)
+        {
+            memcpy(&word_a, a + idx, sizeof(word_a));
+            memcpy(&word_b, b + idx, sizeof(word_b));
+            if (word_a != word_b) break;
+            idx += sizeof(uint64_t);
+        }
+
+        while (idx < len && a[idx] == b[idx]) idx++;
+
+        if (idx >= len) break;
+
+        size_t run_start = idx;
+        size_t run_end = idx;
+
+        while (idx < len && idx - run_end < CODEC_DELTA_GAP_MIN)
+        {
+            if (a[idx] != b[idx]) run_end = idx + 1;
+            idx++;
+        }
+
+        idx = run_end;
+
+        if (!codec_write_varint(out, dst_capacity, &out_idx, run_start - skip_start)
+            || !codec_write_varint(out, dst_capacity, &out_idx, run_end - run_start)
+            || out_idx + (run_end - run_start) > dst_capacity)
+        {
+            return false;
+        }
+
+        for (size_t i = run_start; i < run_end; i++)
+        {
+            out[out_idx++] = a[i] ^ b[i];
+        }
+    }
+
+    *delta_len = out_idx;
+    return true;
+}
+
+/**
+ * @brief Applies a delta from codec_delta_encode() to 'target' in place, in either direction.
+ *
+ * @retval false if the delta is malformed or reaches past 'len', in which case 'target' is unchanged.
+ */
+bool codec_delta_apply(const void *delta, size_t delta_len, void *target, size_t len)
+{
+    const uint8_t *in = (const uint8_t *)delta;
+    uint8_t *out = (uint8_t *)target;
+
+    /// validate everything first so a bad delta never leaves a half-applied target
+    for (uint8_t pass = 0; pass < 2; pass++)
+    {
+        size_t in_idx = 0;
+        size_t out_idx = 0;
+
+        while (in_idx < delta_len)
+        {
+            size_t skip = 0;
+            size_t run = 0;
+
+            if (!codec_read_varint(in, delta_len, &in_idx, &skip)
+                || !codec_read_varint(in, delta_len, &in_idx, &run)
+                || skip > len - out_idx || run > len - out_idx - skip || run > delta_len - in_idx)
+            {
+                return false;
+            }
+
+            out_idx += skip;
+
+            if (pass > 0)
+            {
+                for (size_t i = 0; i < run; i++) out[out_idx + i] ^= in[in_idx + i];
+            }
+
+            out_idx += run;
+            in_idx += run;
+        }
+    }
+
+    return true;
+}
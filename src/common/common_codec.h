@@ -0,0 +1,45 @@
+#ifndef COMMON_CODEC_H
+#define COMMON_CODEC_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CODEC_RLE_RUN_MIN (3)
+#define CODEC_RLE_RUN_MAX (127 + CODEC_RLE_RUN_MIN)
+#define CODEC_RLE_LITERAL_MAX (128)
+
+/// unchanged bytes that end a run of changes in a delta; shorter gaps are cheaper to include in the run
+#define CODEC_DELTA_GAP_MIN (8)
+
+#define CODEC_PACK_MAGIC (0x4b504353u) // "SCPK"
+#define CODEC_PACK_VERSION (1)
+
+typedef struct CodecPackHeader CodecPackHeader_t;
+
+/**
+ * Prefix of a packed blob: identifies the format and describes
+ * the compressed payload that follows and the data it expands to.
+ */
+struct CodecPackHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t raw_bytes;
+    uint32_t packed_bytes;
+    uint64_t checksum;
+};
+
+uint64_t codec_checksum(const void *data, size_t len);
+size_t codec_rle_bound(size_t len);
+size_t codec_rle_encode(const void *src, size_t len, void *dst, size_t dst_capacity);
+size_t codec_rle_decode(const void *src, size_t len, void *dst, size_t dst_capacity);
+size_t codec_pack_bound(size_t raw_len);
+size_t codec_pack(const void *raw, size_t raw_len, void *dst, size_t dst_capacity);
+bool codec_is_packed(const void *src, size_t len);
+size_t codec_unpack(const void *src, size_t len, void *raw, size_t raw_capacity);
+bool codec_delta_encode(const void *prev, const void *cur, size_t len, void *dst, size_t dst_capacity, size_t *delta_len);
+bool codec_delta_apply(const void *delta, size_t delta_len, void *target, size_t len);
+
+#endif
@@ -6,6 +6,11 @@
 #include <stdbool.h>
 
 #include "common_structs.h"
+#include "common_spsc.h"
+#include "common_arena.h"
+#include "common_rect.h"
+#include "common_workers.h"
+#include "common_render.h"
 
 #define DEBUG_MESSAGE_MAX_LEN (256)
 
@@ -15,10 +20,40 @@ typedef struct PlatformSettings PlatformSettings_t;
 
 typedef struct AppMemoryPartition AppMemoryPartition_t;
 
+/**
+ * Layouts a gfx buffer (and every texture drawn into it) may use.
+ * XRGB8888 is a native-endian uint32 0xAARRGGBB, whose alpha byte only marks texture transparency (0)
+ * and is ignored by the display, so presenting it needs no per-frame conversion.
+ */
+typedef enum PixelFormat
+{
+    PIXEL_FORMAT_INDEX8 = 0,
+    PIXEL_FORMAT_RGB24 = 1,
+    PIXEL_FORMAT_XRGB8888 = 2,
+} PixelFormat_t;
+
+#define PIXEL_FORMAT_BIT(format) (1u << (format))
+
+static inline uint8_t pixel_format_size_bytes(PixelFormat_t format)
+{
+    switch (format)
+    {
+    case PIXEL_FORMAT_XRGB8888:
+        return 4;
+    case PIXEL_FORMAT_RGB24:
+        return 3;
+    case PIXEL_FORMAT_INDEX8:
+    default:
+        return 1;
+    }
+}
+
 typedef void (*AppSetupFunc)(const Platform_t *interface);
 typedef void (*AppInitFunc)(const Platform_t *interface, AppMemoryPartition_t *memory);
 typedef void (*AppLoopFunc)(void);
 typedef void (*AppExitFunc)(void);
+typedef size_t (*AppSerializeFunc)(void *dest, size_t max_len);
+typedef bool (*AppDeserializeFunc)(const void *src, size_t len);
 
 struct PlatformCapabilities
 {
@@ -28,6 +63,9 @@ struct PlatformCapabilities
     uint32_t gfx_buffer_width_max;
     uint32_t gfx_buffer_height_max;
     uint8_t gfx_pixel_max_bytes;
+    /// bitmask of PIXEL_FORMAT_BIT() for every format the platform can present
+    uint32_t gfx_pixel_formats;
+    uint32_t gfx_command_capacity_max;
 
     uint32_t gfx_frame_time_min_us;
 
@@ -35,6 +73,8 @@ struct PlatformCapabilities
     uint32_t audio_buffer_capacity_max;
 
     uint16_t input_buffer_capacity_max;
+
+    uint8_t worker_thread_count_max;
 };
 
 struct PlatformSettings
@@ -45,6 +85,10 @@ struct PlatformSettings
     uint32_t gfx_buffer_width;
     uint32_t gfx_buffer_height;
     uint8_t gfx_pixel_size_bytes;
+    PixelFormat_t gfx_pixel_format;
+    /// nonzero has the app emit up to this many render commands per frame for the platform to rasterize,
+    /// instead of drawing into the gfx buffer itself
+    uint32_t gfx_command_capacity;
 
     uint32_t gfx_frame_time_target_us;
 
@@ -52,6 +96,9 @@ struct PlatformSettings
     uint32_t audio_buffer_capacity;
 
     uint16_t input_buffer_capacity;
+
+    /// threads running parallel batches, the main thread included; 1 runs them serially
+    uint8_t worker_thread_count;
 };
 
 struct Platform
@@ -61,6 +108,7 @@ struct Platform
     PlatformSettings_t *settings;
     // time
     int64_t (*time_get_delta_us)(void);
+    int64_t (*time_get_monotonic_us)(void);
     // audio
     float (*audio_get_volume)(void);
     void (*audio_set_volume)(float);
@@ -70,6 +118,8 @@ struct Platform
     size_t (*storage_load_text)(const char *name, char *dest, size_t max_len);
     void (*storage_save_state)(char *state_name);
     void (*storage_load_state)(char *state_name);
+    // threads
+    void (*workers_run)(WorkerJobFunc func, void *context, uint32_t job_count);
     // utils
     bool (*get_should_terminate)(void);
     void (*set_should_terminate)(bool value);
@@ -83,9 +133,12 @@ struct AppMemoryPartition
     Memory_t *serializable;
     Memory_t *ephemeral;
 
-    UniformRing_t *input_buffer;
+    Ring_InputEvent_t *input_buffer;
     Texture_t *gfx_buffer;
-    UniformRing_t *audio_buffer;
+    GfxDirtyList_t *gfx_dirty;
+    /// NULL unless the render command mode was requested, see PlatformSettings_t
+    RenderCommandList_t *gfx_commands;
+    SpscRing_t *audio_buffer;
 };
 
 #endif
@@ -0,0 +1,84 @@
+#include "common_rect.h"
+
+bool rect_is_empty(GfxRect_t rect)
+{
+    return rect.w <= 0 || rect.h <= 0;
+}
+
+bool rect_equals(GfxRect_t a, GfxRect_t b)
+{
+    return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+
+bool rect_overlaps(GfxRect_t a, GfxRect_t b)
+{
+    return !rect_is_empty(rect_intersect(a, b));
+}
+
+GfxRect_t rect_intersect(GfxRect_t a, GfxRect_t b)
+{
+    int32_t min_x = a.x > b.x ? a.x : b.x;
+    int32_t min_y = a.y > b.y ? a.y : b.y;
+    int32_t max_x = (a.x + a.w) < (b.x + b.w) ? (a.x + a.w) : (b.x + b.w);
+    int32_t max_y = (a.y + a.h) < (b.y + b.h) ? (a.y + a.h) : (b.y + b.h);
+
+    GfxRect_t result = { min_x, min_y, max_x - min_x, max_y - min_y };
+    return result;
+}
+
+/**
+ * @brief Returns the bounding rectangle of both, ignoring either one if it is empty.
+ */
+GfxRect_t rect_union(GfxRect_t a, GfxRect_t b)
+{
+    if (rect_is_empty(a)) return b;
+    if (rect_is_empty(b)) return a;
+
+    int32_t min_x = a.x < b.x ? a.x : b.x;
+    int32_t min_y = a.y < b.y ? a.y : b.y;
+    int32_t max_x = (a.x + a.w) > (b.x + b.w) ? (a.x + a.w) : (b.x + b.w);
+    int32_t max_y = (a.y + a.h) > (b.y + b.h) ? (a.y + a.h) : (b.y + b.h);
+
+    GfxRect_t result = { min_x, min_y, max_x - min_x, max_y - min_y };
+    return result;
+}
+
+void gfx_dirty_reset(GfxDirtyList_t *dirty, bool full)
+{
+    dirty->full = full;
+    dirty->count = 0;
+}
+
+/**
+ * @brief Adds a rectangle, clipped to the given bounds, to the dirty list.
+ *
+ * @details
+ * A rectangle overlapping one already listed is merged into it, since redrawing the union
+ * usually costs less than redrawing the overlap twice. A full list falls back to 'full'.
+ */
+void gfx_dirty_add(GfxDirtyList_t *dirty, GfxRect_t rect, GfxRect_t bounds)
+{
+    if (dirty->full) return;
+
+    rect = rect_intersect(rect, bounds);
+    if (rect_is_empty(rect)) return;
+
+    for (uint32_t i = 0; i < dirty->count; i++)
+    {
+        if (rect_overlaps(dirty->rects[i], rect))
+        {
+            dirty->rects[i] = rect_union(dirty->rects[i], rect);
+            return;
+        }
+    }
+
+    if (dirty->count >= GFX_DIRTY_RECTS_MAX)
+    {
+        dirty->full = true;
+        dirty->count = 0;
+        return;
+    }
+
+    dirty->rects[dirty->count] = rect;
+    dirty->count++;
+}
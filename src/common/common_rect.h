@@ -0,0 +1,42 @@
+#ifndef COMMON_RECT_H
+#define COMMON_RECT_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define GFX_DIRTY_RECTS_MAX (64)
+
+typedef struct GfxRect GfxRect_t;
+typedef struct GfxDirtyList GfxDirtyList_t;
+
+/// a pixel rectangle, empty when either dimension is zero or negative
+struct GfxRect
+{
+    int32_t x;
+    int32_t y;
+    int32_t w;
+    int32_t h;
+};
+
+/**
+ * The gfx buffer regions changed since the platform last presented it.
+ * The app adds to it while drawing, the platform presents only these regions and then resets it.
+ * 'full' stands for the whole buffer, and is also what an overflowing list degrades to.
+ */
+struct GfxDirtyList
+{
+    bool full;
+    uint32_t count;
+    GfxRect_t rects[GFX_DIRTY_RECTS_MAX];
+};
+
+bool rect_is_empty(GfxRect_t rect);
+bool rect_equals(GfxRect_t a, GfxRect_t b);
+bool rect_overlaps(GfxRect_t a, GfxRect_t b);
+GfxRect_t rect_intersect(GfxRect_t a, GfxRect_t b);
+GfxRect_t rect_union(GfxRect_t a, GfxRect_t b);
+void gfx_dirty_reset(GfxDirtyList_t *dirty, bool full);
+void gfx_dirty_add(GfxDirtyList_t *dirty, GfxRect_t rect, GfxRect_t bounds);
+
+#endif
@@ -0,0 +1,258 @@
+#include "common_render.h"
+
+#include <string.h>
+
+#define RENDER_BANDS_PER_THREAD (4)
+#define RENDER_BAND_HEIGHT_MIN (16)
+
+/// the shared parameters of one parallel execution, see render_execute_parallel()
+typedef struct RenderBandBatch
+{
+    const RenderCommandList_t *list;
+    const Memory_t *textures;
+    Texture_t *target;
+    int32_t band_height;
+} RenderBandBatch_t;
+
+size_t render_list_required_bytes(uint32_t capacity)
+{
+    return sizeof(RenderCommandList_t) + ((size_t)capacity * sizeof(RenderCommand_t));
+}
+
+RenderCommandList_t* render_list_create(uint32_t capacity)
+{
+    if (capacity > RENDER_COMMANDS_CAPACITY_MAX) capacity = RENDER_COMMANDS_CAPACITY_MAX;
+
+    RenderCommandList_t *list = (RenderCommandList_t *)calloc(1, render_list_required_bytes(capacity));
+
+    if (list != NULL) list->capacity = capacity;
+
+    return list;
+}
+
+void render_list_reset(RenderCommandList_t *list)
+{
+    list->count = 0;
+    list->overflowed = false;
+}
+
+/**
+ * @retval true  The command was appended.
+ * @retval false The list is full, the command was dropped.
+ */
+bool render_list_push(RenderCommandList_t *list, RenderCommand_t command)
+{
+    if (list->count >= list->capacity)
+    {
+        list->overflowed = true;
+        return false;
+    }
+
+    list->commands[list->count] = command;
+    list->count++;
+    return true;
+}
+
+bool render_list_equals(const RenderCommandList_t *a, const RenderCommandList_t *b)
+{
+    return a->count == b->count && a->overflowed == b->overflowed
+        && memcmp(a->commands, b->commands, (size_t)a->count * sizeof(RenderCommand_t)) == 0;
+}
+
+/**
+ * @brief Copies as many of the source's commands as the destination holds.
+ */
+void render_list_copy(RenderCommandList_t *dest, const RenderCommandList_t *src)
+{
+    uint32_t count = src->count < dest->capacity ? src->count : dest->capacity;
+
+    memcpy(dest->commands, src->commands, (size_t)count * sizeof(RenderCommand_t));
+    dest->count = count;
+    dest->overflowed = src->overflowed || count < src->count;
+}
+
+static void render_put_pixel(uint8_t *dest, uint32_t value, uint8_t pixel_size)
+{
+    if (pixel_size == 4)
+    {
+        memcpy(dest, &value, 4);
+        return;
+    }
+
+    for (uint8_t i = 0; i < pixel_size; i++)
+    {
+        dest[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+/**
+ * @brief Resolves a sprite command's texture, or NULL if it does not lie within the partition
+ * or does not match the target's pixel size.
+ */
+static const Texture_t* render_get_texture(const Memory_t *textures, uint32_t offset, uint8_t pixel_size)
+{
+    if ((size_t)offset + sizeof(Texture_t) > textures->size_bytes) return NULL;
+
+    const Texture_t *texture = (const Texture_t *)(textures->buffer + offset);
+    size_t pixels_bytes = (size_t)texture->width * texture->height * texture->pixel_size_bytes;
+
+    if (texture->pixel_size_bytes != pixel_size || (size_t)offset + sizeof(Texture_t) + pixels_bytes > textures->size_bytes) return NULL;
+
+    return texture;
+}
+
+static void render_sprite(const RenderCommand_t *command, const Memory_t *textures, Texture_t *target, GfxRect_t clip)
+{
+    const size_t pixel_size = target->pixel_size_bytes;
+    const Texture_t *texture = render_get_texture(textures, command->value, pixel_size);
+
+    if (texture == NULL) return;
+
+    GfxRect_t rect = { command->x0, command->y0, texture->width, texture->height };
+    GfxRect_t visible = rect_intersect(rect, clip);
+
+    if (rect_is_empty(visible)) return;
+
+    for (int32_t y = visible.y; y < visible.y + visible.h; y++)
+    {
+        uint8_t *dest = target->pixels + (pixel_size * (size_t)(visible.x + (y * target->width)));
+        const uint8_t *src = texture->pixels + (pixel_size * (size_t)((visible.x - rect.x) + ((y - rect.y) * texture->width)));
+
+        if (command->flags & RENDER_SPRITE_FLAG_OPAQUE)
+        {
+            memcpy(dest, src, pixel_size * visible.w);
+            continue;
+        }
+
+        for (int32_t x = 0; x < visible.w; x++, dest += pixel_size, src += pixel_size)
+        {
+            if (!texel_is_transparent(src, pixel_size)) memcpy(dest, src, pixel_size);
+        }
+    }
+}
+
+static void render_fill_rect(const RenderCommand_t *command, Texture_t *target, GfxRect_t clip)
+{
+    const size_t pixel_size = target->pixel_size_bytes;
+    GfxRect_t rect = { command->x0, command->y0, command->x1 - command->x0, command->y1 - command->y0 };
+    GfxRect_t visible = rect_intersect(rect, clip);
+
+    if (rect_is_empty(visible)) return;
+
+    for (int32_t y = visible.y; y < visible.y + visible.h; y++)
+    {
+        uint8_t *dest = target->pixels + (pixel_size * (size_t)(visible.x + (y * target->width)));
+
+        if (command->value == 0)
+        {
+            memset(dest, 0, pixel_size * visible.w);
+            continue;
+        }
+
+        for (int32_t x = 0; x < visible.w; x++, dest += pixel_size)
+        {
+            render_put_pixel(dest, command->value, pixel_size);
+        }
+    }
+}
+
+/**
+ * @brief Bresenham's line, clipped pixel by pixel; lines are only used for debug overlays.
+ */
+static void render_line(const RenderCommand_t *command, Texture_t *target, GfxRect_t clip)
+{
+    int32_t x = command->x0;
+    int32_t y = command->y0;
+    int32_t dx = abs(command->x1 - command->x0);
+    int32_t dy = -abs(command->y1 - command->y0);
+    int32_t step_x = command->x0 < command->x1 ? 1 : -1;
+    int32_t step_y = command->y0 < command->y1 ? 1 : -1;
+    int32_t error = dx + dy;
+
+    while (true)
+    {
+        if (x >= clip.x && x < clip.x + clip.w && y >= clip.y && y < clip.y + clip.h)
+        {
+            render_put_pixel(target->pixels + (target->pixel_size_bytes * (size_t)(x + (y * target->width))),
+                    command->value, target->pixel_size_bytes);
+        }
+
+        if (x == command->x1 && y == command->y1) break;
+
+        int32_t error2 = 2 * error;
+
+        if (error2 >= dy)
+        {
+            error += dy;
+            x += step_x;
+        }
+
+        if (error2 <= dx)
+        {
+            error += dx;
+            y += step_y;
+        }
+    }
+}
+
+/**
+ * @brief Rasterizes a command list into the target, in order, touching only pixels within 'clip'.
+ * Sprite textures are looked up in the given partition; commands referring outside of it are skipped.
+ */
+void render_execute(const RenderCommandList_t *list, const Memory_t *textures, Texture_t *target, GfxRect_t clip)
+{
+    GfxRect_t target_rect = { 0, 0, target->width, target->height };
+    clip = rect_intersect(clip, target_rect);
+
+    if (rect_is_empty(clip)) return;
+
+    for (uint32_t i = 0; i < list->count; i++)
+    {
+        const RenderCommand_t *command = &list->commands[i];
+
+        switch (command->type)
+        {
+        case RENDER_COMMAND_SPRITE:
+            render_sprite(command, textures, target, clip);
+            break;
+        case RENDER_COMMAND_FILL_RECT:
+            render_fill_rect(command, target, clip);
+            break;
+        case RENDER_COMMAND_LINE:
+            render_line(command, target, clip);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Rasterizes one horizontal band of the target, see render_execute_parallel().
+ * Must match prototype @ref WorkerJobFunc.
+ */
+static void render_execute_band(void *context, uint32_t band_idx)
+{
+    const RenderBandBatch_t *batch = (const RenderBandBatch_t *)context;
+    GfxRect_t band = { 0, (int32_t)band_idx * batch->band_height, batch->target->width, batch->band_height };
+
+    render_execute(batch->list, batch->textures, batch->target, band);
+}
+
+/**
+ * @brief Rasterizes a command list into the whole target, split into horizontal bands across the pool.
+ * Each band replays every command clipped to itself, so the result is identical to a serial execution.
+ */
+void render_execute_parallel(WorkerPool_t *pool, const RenderCommandList_t *list, const Memory_t *textures, Texture_t *target)
+{
+    uint32_t thread_count = workers_get_thread_count(pool);
+    uint32_t band_count = thread_count > 1 ? thread_count * RENDER_BANDS_PER_THREAD : 1;
+
+    RenderBandBatch_t batch = { list, textures, target, (target->height + band_count - 1) / band_count };
+
+    if (batch.band_height < RENDER_BAND_HEIGHT_MIN) batch.band_height = RENDER_BAND_HEIGHT_MIN;
+
+    band_count = (target->height + batch.band_height - 1) / batch.band_height;
+
+    workers_run(pool, render_execute_band, &batch, band_count);
+}
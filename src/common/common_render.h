@@ -0,0 +1,68 @@
+#ifndef COMMON_RENDER_H
+#define COMMON_RENDER_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "common_structs.h"
+#include "common_rect.h"
+#include "common_workers.h"
+
+#define RENDER_COMMANDS_CAPACITY_MAX (16384)
+
+/// the sprite's texture is copied whole, without testing texels for transparency
+#define RENDER_SPRITE_FLAG_OPAQUE (1u << 0)
+
+typedef struct RenderCommand RenderCommand_t;
+typedef struct RenderCommandList RenderCommandList_t;
+
+typedef enum RenderCommandType
+{
+    RENDER_COMMAND_SPRITE = 0,
+    RENDER_COMMAND_FILL_RECT = 1,
+    RENDER_COMMAND_LINE = 2,
+} RenderCommandType_t;
+
+/**
+ * One draw of a frame, in buffer coordinates.
+ * SPRITE draws the texture at byte offset 'value' of the app's ephemeral partition with its top-left corner at (x0,y0).
+ * FILL_RECT fills the rectangle from (x0,y0) up to, not including, (x1,y1) with the pixel value 'value'.
+ * LINE draws a line from (x0,y0) to (x1,y1), both included, with the pixel value 'value'.
+ * Pixel values are written in the buffer's own format: whole for XRGB8888, the low 3 or 1 bytes otherwise.
+ * Every byte is defined, so that two lists may be compared with memcmp().
+ */
+struct RenderCommand
+{
+    uint8_t type;
+    uint8_t flags;
+    int16_t x0;
+    int16_t y0;
+    int16_t x1;
+    int16_t y1;
+    uint16_t reserved;
+    uint32_t value;
+};
+
+/**
+ * The draws making up one frame, in order, appended by the app and rasterized by the platform,
+ * which then resets it for the next frame. Pushing past the capacity drops the command and sets 'overflowed'.
+ */
+struct RenderCommandList
+{
+    uint32_t capacity;
+    uint32_t count;
+    bool overflowed;
+    RenderCommand_t commands[];
+};
+
+size_t render_list_required_bytes(uint32_t capacity);
+RenderCommandList_t* render_list_create(uint32_t capacity);
+void render_list_reset(RenderCommandList_t *list);
+bool render_list_push(RenderCommandList_t *list, RenderCommand_t command);
+bool render_list_equals(const RenderCommandList_t *a, const RenderCommandList_t *b);
+void render_list_copy(RenderCommandList_t *dest, const RenderCommandList_t *src);
+void render_execute(const RenderCommandList_t *list, const Memory_t *textures, Texture_t *target, GfxRect_t clip);
+void render_execute_parallel(WorkerPool_t *pool, const RenderCommandList_t *list, const Memory_t *textures, Texture_t *target);
+
+#endif
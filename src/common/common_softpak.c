@@ -0,0 +1,165 @@
+#include "common_softpak.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/// a validated asset pack, mapped read-only for as long as it is open
+struct Softpak
+{
+    const uint8_t *base;
+    size_t size;
+    const SoftpakHeader_t *header;
+    const SoftpakEntry_t *entries;
+};
+
+/**
+ * @brief Checks that the header is ours and that the entries and their payloads lie within the file.
+ */
+static bool softpak_validate(const uint8_t *base, size_t size)
+{
+    if (size < sizeof(SoftpakHeader_t)) return false;
+
+    const SoftpakHeader_t *header = (const SoftpakHeader_t *)base;
+
+    if (memcmp(header->magic, SOFTPAK_MAGIC, sizeof(SOFTPAK_MAGIC)) != 0
+        || header->version != SOFTPAK_VERSION
+        || header->texture_header_bytes != sizeof(Texture_t)
+        || header->clip_header_bytes != sizeof(AudioClip_t)
+        || header->toc_offset % sizeof(uint64_t) != 0
+        || header->toc_offset > size
+        || header->entry_count > (size - header->toc_offset) / sizeof(SoftpakEntry_t))
+    {
+        return false;
+    }
+
+    const SoftpakEntry_t *entries = (const SoftpakEntry_t *)(base + header->toc_offset);
+
+    for (uint32_t i = 0; i < header->entry_count; i++)
+    {
+        if (entries[i].offset % SOFTPAK_ALIGNMENT != 0
+            || entries[i].offset > size
+            || entries[i].size > size - entries[i].offset
+            || memchr(entries[i].name, '\0', sizeof(entries[i].name)) == NULL)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Checks that a baked texture's or clip's own header describes no more data than its entry holds,
+ * as the loaders copy it out and size everything after it by that header.
+ */
+static bool softpak_payload_fits(const uint8_t *payload, SoftpakEntryType_t type, size_t size)
+{
+    if (type == SOFTPAK_ENTRY_TEXTURE)
+    {
+        if (size < sizeof(Texture_t)) return false;
+
+        const Texture_t *texture = (const Texture_t *)payload;
+        return texture->pixel_size_bytes > 0
+            && (uint64_t)texture->width * texture->height * texture->pixel_size_bytes <= size - sizeof(Texture_t);
+    }
+
+    if (type == SOFTPAK_ENTRY_SOUND)
+    {
+        if (size < sizeof(AudioClip_t)) return false;
+
+        const AudioClip_t *clip = (const AudioClip_t *)payload;
+        return (uint64_t)clip->num_samples * sizeof(float) <= size - sizeof(AudioClip_t);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Maps an asset pack baked by the softpak baker.
+ *
+ * @retval The pack, or NULL if the file is missing, could not be mapped or is not a pack this build can read.
+ */
+Softpak_t* softpak_open(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) return NULL;
+
+    struct stat file_stat;
+
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    size_t size = file_stat.st_size;
+    void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    /// the mapping holds its own reference to the file
+    close(fd);
+
+    if (mapping == MAP_FAILED) return NULL;
+
+    Softpak_t *pak = malloc(sizeof(Softpak_t));
+
+    if (pak == NULL || !softpak_validate((const uint8_t *)mapping, size))
+    {
+        free(pak);
+        munmap(mapping, size);
+        return NULL;
+    }
+
+    /// every asset is read once at startup, so have it all paged in ahead of the loads
+    madvise(mapping, size, MADV_WILLNEED);
+
+    pak->base = (const uint8_t *)mapping;
+    pak->size = size;
+    pak->header = (const SoftpakHeader_t *)mapping;
+    pak->entries = (const SoftpakEntry_t *)(pak->base + pak->header->toc_offset);
+
+    return pak;
+}
+
+void softpak_close(Softpak_t *pak)
+{
+    if (pak == NULL) return;
+
+    munmap((void *)pak->base, pak->size);
+    free(pak);
+}
+
+uint32_t softpak_get_entry_count(const Softpak_t *pak)
+{
+    return pak != NULL ? pak->header->entry_count : 0;
+}
+
+/**
+ * @brief Looks up an asset by the name of the file it was baked from, its type and, for textures, its pixel format.
+ *
+ * @retval The asset's bytes within the mapping, valid until the pack is closed, with their count in 'size_out';
+ * NULL if the pack is NULL or holds no such asset, or if a texture's or clip's header does not fit its entry,
+ * so that a stale or corrupt asset is loaded from its loose file instead.
+ */
+const void* softpak_find(const Softpak_t *pak, const char *name, SoftpakEntryType_t type, uint32_t format, size_t *size_out)
+{
+    if (pak == NULL) return NULL;
+
+    for (uint32_t i = 0; i < pak->header->entry_count; i++)
+    {
+        const SoftpakEntry_t *entry = &pak->entries[i];
+
+        if (entry->type == type && entry->format == format && strcmp(entry->name, name) == 0)
+        {
+            if (!softpak_payload_fits(pak->base + entry->offset, type, entry->size)) return NULL;
+
+            *size_out = entry->size;
+            return pak->base + entry->offset;
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,60 @@
+#ifndef COMMON_SOFTPAK_H
+#define COMMON_SOFTPAK_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "common_structs.h"
+
+#define SOFTPAK_MAGIC "SOFTPAK"
+#define SOFTPAK_VERSION (1)
+#define SOFTPAK_NAME_MAX_LEN (64)
+/// every payload starts at a multiple of this, so baked textures and clips keep their pixel and sample alignment
+#define SOFTPAK_ALIGNMENT (COMMON_SIMD_ALIGNMENT)
+
+typedef struct Softpak Softpak_t;
+typedef struct SoftpakHeader SoftpakHeader_t;
+typedef struct SoftpakEntry SoftpakEntry_t;
+
+typedef enum SoftpakEntryType
+{
+    /// a text file's bytes as they are
+    SOFTPAK_ENTRY_TEXT = 0,
+    /// a Texture_t as it lies in memory, in the pixel format given with the entry
+    SOFTPAK_ENTRY_TEXTURE = 1,
+    /// an AudioClip_t as it lies in memory, float samples
+    SOFTPAK_ENTRY_SOUND = 2,
+} SoftpakEntryType_t;
+
+/**
+ * At the start of an asset pack, followed by the payloads and, at 'toc_offset', 'entry_count' entries.
+ * The struct header sizes must match the reader's, as baked textures and clips are copied out whole.
+ */
+struct SoftpakHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t entry_count;
+    uint64_t toc_offset;
+    uint32_t texture_header_bytes;
+    uint32_t clip_header_bytes;
+};
+
+/// one asset, named after the file it was baked from
+struct SoftpakEntry
+{
+    char name[SOFTPAK_NAME_MAX_LEN];
+    uint32_t type;
+    /// PixelFormat_t for textures, 0 otherwise
+    uint32_t format;
+    uint64_t offset;
+    uint64_t size;
+};
+
+Softpak_t* softpak_open(const char *path);
+void softpak_close(Softpak_t *pak);
+uint32_t softpak_get_entry_count(const Softpak_t *pak);
+const void* softpak_find(const Softpak_t *pak, const char *name, SoftpakEntryType_t type, uint32_t format, size_t *size_out);
+
+#endif
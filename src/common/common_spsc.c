@@ -0,0 +1,194 @@
+#include "common_spsc.h"
+#include <string.h>
+
+/**
+ * @brief Returns the smallest power of two greater than or equal to the given capacity.
+ */
+uint32_t spsc_round_capacity(uint32_t capacity)
+{
+    return ring_capacity_pow2(capacity);
+}
+
+/**
+ * @brief Returns the number of bytes a ring of the given (requested) capacity occupies,
+ * including the header and the power-of-two rounding applied by spsc_init().
+ */
+size_t spsc_required_bytes(uint32_t capacity, uint8_t unit_size)
+{
+    return sizeof(SpscRing_t) + ((size_t)spsc_round_capacity(capacity) * unit_size);
+}
+
+SpscRing_t* spsc_create(uint32_t capacity, uint8_t unit_size)
+{
+    void *ring_ptr = NULL;
+
+    if (posix_memalign(&ring_ptr, SPSC_CACHE_LINE_BYTES, spsc_required_bytes(capacity, unit_size)) != 0)
+    {
+        return NULL;
+    }
+
+    spsc_init((SpscRing_t *)ring_ptr, capacity, unit_size);
+    return (SpscRing_t *)ring_ptr;
+}
+
+/**
+ * @brief Initializes a ring in place. The capacity is rounded up to a power of two,
+ * so the memory at 'ring' must hold at least spsc_required_bytes(capacity, unit_size).
+ * Must not be called while a producer or consumer is active.
+ */
+void spsc_init(SpscRing_t *ring, uint32_t capacity, uint8_t unit_size)
+{
+    ring->capacity = spsc_round_capacity(capacity);
+    ring->mask = ring->capacity - 1;
+    ring->unit_size = unit_size;
+    ring->head = 0;
+    ring->tail = 0;
+    bzero(ring->buffer, (size_t)ring->capacity * ring->unit_size);
+}
+
+/**
+ * @brief Returns the number of live units. Exact when called from either side,
+ * a momentary snapshot when called from any other thread.
+ */
+uint32_t spsc_length(const SpscRing_t *ring)
+{
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    return tail - head;
+}
+
+/**
+ * @brief Copies up to 'len' units into the ring. Producer side only.
+ *
+ * @details
+ * Never overwrites live units - whatever does not fit is dropped and left to the caller.
+ * The units are published to the consumer with a single release store of 'tail'.
+ *
+ * @retval The number of units actually pushed.
+ */
+uint32_t spsc_push(SpscRing_t *ring, const void *chunk, uint32_t len)
+{
+    const uint8_t *cast_chunk = (const uint8_t *)chunk;
+
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint32_t free_count = ring->capacity - (tail - head);
+
+    if (len > free_count) len = free_count;
+    if (len == 0) return 0;
+
+    uint32_t start_idx = tail & ring->mask;
+    uint32_t first_len = ring->capacity - start_idx;
+    if (first_len > len) first_len = len;
+
+    memcpy(ring->buffer + ((size_t)start_idx * ring->unit_size), cast_chunk, (size_t)first_len * ring->unit_size);
+    memcpy(ring->buffer, cast_chunk + ((size_t)first_len * ring->unit_size), (size_t)(len - first_len) * ring->unit_size);
+
+    __atomic_store_n(&ring->tail, tail + len, __ATOMIC_RELEASE);
+
+    return len;
+}
+
+/**
+ * @brief Copies up to 'len' units out of the ring. Consumer side only.
+ *
+ * @details
+ * The slots are handed back to the producer with a single release store of 'head'.
+ *
+ * @retval The number of units actually popped.
+ */
+uint32_t spsc_pop(SpscRing_t *ring, void *out, uint32_t len)
+{
+    uint8_t *cast_out = (uint8_t *)out;
+
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    uint32_t live_count = tail - head;
+
+    if (len > live_count) len = live_count;
+    if (len == 0) return 0;
+
+    uint32_t start_idx = head & ring->mask;
+    uint32_t first_len = ring->capacity - start_idx;
+    if (first_len > len) first_len = len;
+
+    memcpy(cast_out, ring->buffer + ((size_t)start_idx * ring->unit_size), (size_t)first_len * ring->unit_size);
+    memcpy(cast_out + ((size_t)first_len * ring->unit_size), ring->buffer, (size_t)(len - first_len) * ring->unit_size);
+
+    __atomic_store_n(&ring->head, head + len, __ATOMIC_RELEASE);
+
+    return len;
+}
+
+/**
+ * @brief Writes a value from a given offset into the ring buffer to a given 'out' location, without modifying the ring.
+ *
+ * @details
+ * Same leniency as ring_peek(): 'dead' values and offsets past the capacity are allowed.
+ * Safe to call from the producer thread or a monitoring thread; a unit read concurrently
+ * with the producer writing it may be torn, which is acceptable for visualization only.
+ *
+ * @param [in]  ring     The ring buffer to be read.
+ * @param [in]  offset   The offset at which to read into the ring buffer.
+ * @param [out] out      The destination to which the read value will be written.
+ * @param [in]  absolute If true, the offset will absolute from index 0. If false, the offset will be from the current 'head'.
+ *
+ * @retval true  The value written to 'out' originated from the "live" section of the ring.
+ * @retval false The value written to 'out' originated from the "dead" section of the ring.
+ */
+bool spsc_peek(const SpscRing_t *ring, uint32_t offset, void *out, bool absolute)
+{
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    uint32_t peek_idx = (absolute ? offset : (head + offset)) & ring->mask;
+    memcpy(out, ring->buffer + ((size_t)peek_idx * ring->unit_size), ring->unit_size);
+
+    return ((peek_idx - head) & ring->mask) < (tail - head)
+        || (tail - head) >= ring->capacity;
+}
+
+/**
+ * @brief Describes the live units as up to two contiguous spans, oldest first, for reading in place.
+ *
+ * @details
+ * From the consumer this is the zero-copy counterpart of spsc_pop(), finished with spsc_commit_read().
+ * From the producer's thread the spans are stable until its next push; from any other thread
+ * they are a snapshot whose oldest units may be recycled by the producer while being read.
+ *
+ * @retval The number of non-empty spans (0, 1 or 2).
+ */
+uint8_t spsc_read_spans(const SpscRing_t *ring, RingSpan_t spans[2])
+{
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    uint32_t live_count = tail - head;
+
+    uint32_t start_idx = head & ring->mask;
+    uint32_t first_len = ring->capacity - start_idx;
+    if (first_len > live_count) first_len = live_count;
+
+    spans[0].ptr = first_len > 0 ? (void *)(ring->buffer + ((size_t)start_idx * ring->unit_size)) : NULL;
+    spans[0].len = first_len;
+    spans[1].ptr = live_count > first_len ? (void *)ring->buffer : NULL;
+    spans[1].len = live_count - first_len;
+
+    return (spans[0].len > 0) + (spans[1].len > 0);
+}
+
+/**
+ * @brief Hands 'len' units read through spsc_read_spans() back to the producer. Consumer side only.
+ *
+ * @retval The number of units released.
+ */
+uint32_t spsc_commit_read(SpscRing_t *ring, uint32_t len)
+{
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    if (len > tail - head) len = tail - head;
+
+    __atomic_store_n(&ring->head, head + len, __ATOMIC_RELEASE);
+
+    return len;
+}
@@ -0,0 +1,50 @@
+#ifndef COMMON_SPSC_H
+#define COMMON_SPSC_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "common_structs.h"
+
+#define SPSC_CACHE_LINE_BYTES (64)
+
+typedef struct SpscRing SpscRing_t;
+
+/**
+ * Lock-free ring buffer for exactly one producer thread and one consumer thread,
+ * e.g. the app loop pushing audio samples and the audio callback draining them.
+ * 'head' and 'tail' are free-running counters masked into the power-of-two capacity,
+ * each on its own cache line so the two sides never write to a shared line.
+ */
+struct SpscRing
+{
+    /// read-only after init, shared by both sides
+    uint32_t capacity;
+    uint32_t mask;
+    uint32_t unit_size;
+    uint8_t config_padding[SPSC_CACHE_LINE_BYTES - (3 * sizeof(uint32_t))];
+
+    /// written by the consumer only
+    uint32_t head;
+    uint8_t head_padding[SPSC_CACHE_LINE_BYTES - sizeof(uint32_t)];
+
+    /// written by the producer only
+    uint32_t tail;
+    uint8_t tail_padding[SPSC_CACHE_LINE_BYTES - sizeof(uint32_t)];
+
+    uint8_t buffer[];
+};
+
+uint32_t spsc_round_capacity(uint32_t capacity);
+size_t spsc_required_bytes(uint32_t capacity, uint8_t unit_size);
+SpscRing_t* spsc_create(uint32_t capacity, uint8_t unit_size);
+void spsc_init(SpscRing_t *ring, uint32_t capacity, uint8_t unit_size);
+uint32_t spsc_length(const SpscRing_t *ring);
+uint32_t spsc_push(SpscRing_t *ring, const void *chunk, uint32_t len);
+uint32_t spsc_pop(SpscRing_t *ring, void *out, uint32_t len);
+bool spsc_peek(const SpscRing_t *ring, uint32_t offset, void *out, bool absolute);
+uint8_t spsc_read_spans(const SpscRing_t *ring, RingSpan_t spans[2]);
+uint32_t spsc_commit_read(SpscRing_t *ring, uint32_t len);
+
+#endif
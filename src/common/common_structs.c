@@ -17,53 +17,107 @@ void ring_init(UniformRing_t *ring, uint32_t capacity, uint8_t unit_size)
     bzero(ring->buffer, ring->capacity * ring->unit_size);
 }
 
+/**
+ * @brief Copies 'len' contiguous units from the ring, starting at a given absolute index, to 'out'.
+ * Splits the copy at the wrap point, so it costs at most two memcpy calls.
+ */
+static void ring_copy_out(const UniformRing_t *ring, uint32_t start_idx, uint8_t *out, uint32_t len)
+{
+    uint32_t first_len = ring->capacity - start_idx;
+    if (first_len > len) first_len = len;
+
+    memcpy(out, ring->buffer+(start_idx*ring->unit_size), first_len*ring->unit_size);
+    memcpy(out+(first_len*ring->unit_size), ring->buffer, (len-first_len)*ring->unit_size);
+}
+
+/**
+ * @brief Appends up to 'len' units to the ring with at most two memcpy calls.
+ *
+ * @details
+ * If the chunk does not fit, either the excess is dropped (overwrite_on_collision == false),
+ * or the oldest live units are discarded to make room, in which case only the newest 'capacity' units of the chunk survive.
+ *
+ * @retval The number of units consumed from 'chunk'.
+ */
 uint32_t ring_push(UniformRing_t *ring, void *chunk, uint32_t len, bool overwrite_on_collision)
 {
     uint8_t *cast_chunk = (uint8_t *)chunk;
-    uint32_t start_idx = (ring->head + ring->length) % ring->capacity;
-    uint32_t pushed_count = 0;
+    uint32_t free_count = ring->capacity - ring->length;
+    uint32_t pushed_count = len;
 
-    for (uint32_t i = 0; i < len; i++)
+    if (len > free_count)
     {
-        uint32_t idx = (start_idx + i) % ring->capacity;
-        memcpy(ring->buffer+(idx*ring->unit_size), cast_chunk+(i*ring->unit_size), ring->unit_size);
-
-        pushed_count++;
-
-        if (ring->length >= ring->capacity)
+        if (!overwrite_on_collision)
         {
-            if (overwrite_on_collision)
-            {
-                ring->head = (ring->head + 1) % ring->capacity;
-            }
-            else
-            {
-                break;
-            }
+            len = free_count;
+            pushed_count = len;
         }
         else
         {
-            ring->length++;
+            if (len > ring->capacity)
+            {
+                cast_chunk += (len - ring->capacity) * ring->unit_size;
+                len = ring->capacity;
+            }
+
+            uint32_t dropped_count = len - free_count;
+            ring->head = (ring->head + dropped_count) % ring->capacity;
+            ring->length -= dropped_count;
         }
     }
 
+    if (len == 0) return 0;
+
+    uint32_t start_idx = (ring->head + ring->length) % ring->capacity;
+    uint32_t first_len = ring->capacity - start_idx;
+    if (first_len > len) first_len = len;
+
+    memcpy(ring->buffer+(start_idx*ring->unit_size), cast_chunk, first_len*ring->unit_size);
+    memcpy(ring->buffer, cast_chunk+(first_len*ring->unit_size), (len-first_len)*ring->unit_size);
+
+    ring->length += len;
+
     return pushed_count;
 }
 
 bool ring_pop(UniformRing_t *ring, void *out)
 {
-    uint8_t *cast_out = (uint8_t *)out;
+    return ring_pop_bulk(ring, out, 1) == 1;
+}
 
-    if (ring->length > 0)
-    {
-        memcpy(cast_out, ring->buffer+(ring->head*ring->unit_size), ring->unit_size);
-        ring->head = (ring->head + 1) % ring->capacity;
-        if (ring->head >= ring->capacity) ring->head = 0;
-        ring->length--;
-        return true;
-    }
+/**
+ * @brief Moves up to 'len' units from the front of the ring to 'out' with at most two memcpy calls.
+ *
+ * @retval The number of units popped.
+ */
+uint32_t ring_pop_bulk(UniformRing_t *ring, void *out, uint32_t len)
+{
+    if (len > ring->length) len = ring->length;
+    if (len == 0) return 0;
+
+    ring_copy_out(ring, ring->head, (uint8_t *)out, len);
+
+    ring->head = (ring->head + len) % ring->capacity;
+    ring->length -= len;
 
-    return false;
+    return len;
+}
+
+/**
+ * @brief Copies up to 'len' live units, starting 'offset' units after the head, to 'out' without modifying the ring.
+ * Unlike ring_peek(), never reads from the "dead" section.
+ *
+ * @retval The number of units copied.
+ */
+uint32_t ring_peek_bulk(const UniformRing_t *ring, uint32_t offset, void *out, uint32_t len)
+{
+    if (offset >= ring->length) return 0;
+    if (len > ring->length - offset) len = ring->length - offset;
+    if (len == 0) return 0;
+
+    ring_copy_out(ring, (ring->head + offset) % ring->capacity, (uint8_t *)out, len);
+
+    return len;
 }
 
 /**
@@ -113,3 +167,60 @@ bool ring_peek_ptr(const UniformRing_t *ring, uint32_t offset, void **out_pptr,
 
     return (peek_idx - ring->head) < ring->length;
 }
+
+/**
+ * @brief Describes the live section of the ring as up to two contiguous spans, oldest units first.
+ *
+ * @details
+ * Zero-copy alternative to popping or peeking unit by unit: the caller reads the units in place
+ * and then releases however many it has used with ring_consume().
+ * The spans are invalidated by any push to the ring.
+ *
+ * @param [in]  ring  The ring buffer to be read.
+ * @param [out] spans Receives the spans; unused entries are set to a null pointer and zero length.
+ *
+ * @retval The number of non-empty spans (0, 1 or 2).
+ */
+uint8_t ring_get_spans(const UniformRing_t *ring, RingSpan_t spans[2])
+{
+    uint32_t first_len = ring->capacity - ring->head;
+    if (first_len > ring->length) first_len = ring->length;
+
+    spans[0].ptr = first_len > 0 ? (void *)(ring->buffer+(ring->head*ring->unit_size)) : NULL;
+    spans[0].len = first_len;
+    spans[1].ptr = ring->length > first_len ? (void *)ring->buffer : NULL;
+    spans[1].len = ring->length - first_len;
+
+    return (spans[0].len > 0) + (spans[1].len > 0);
+}
+
+/**
+ * @brief Releases up to 'len' units from the front of the ring without copying them anywhere.
+ *
+ * @retval The number of units released.
+ */
+uint32_t ring_consume(UniformRing_t *ring, uint32_t len)
+{
+    if (len > ring->length) len = ring->length;
+
+    ring->head = (ring->head + len) % ring->capacity;
+    ring->length -= len;
+
+    return len;
+}
+
+/**
+ * @brief Converts decoded RGB24 texels to XRGB8888, keying transparent ones (see texel_is_transparent()) to a zero alpha byte.
+ * The platforms' texture loaders and the asset pack baker all convert through this, so baked and loose textures agree.
+ */
+void texels_rgb24_to_xrgb8888(uint32_t *dest, const uint8_t *src, size_t texel_count)
+{
+    for (size_t i = 0; i < texel_count; i++)
+    {
+        const uint8_t *texel = &src[3 * i];
+
+        dest[i] = texel_is_transparent(texel, 3)
+            ? 0
+            : 0xFF000000u | ((uint32_t)texel[0] << 16) | ((uint32_t)texel[1] << 8) | texel[2];
+    }
+}
@@ -5,11 +5,19 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "common_typed_ring.h"
+
+/// alignment of texture pixels and audio samples, wide enough for aligned 256-bit SIMD loads
+#define COMMON_SIMD_ALIGNMENT (32)
+/// RGB24 texels whose channels sum to no more than this are transparent, see texel_is_transparent()
+#define TEXEL_KEY_SUM_MAX (31)
+
 typedef struct Memory Memory_t;
 typedef struct Texture Texture_t;
 typedef struct AudioClip AudioClip_t;
 typedef struct UniformRing UniformRing_t;
 typedef struct InputEvent InputEvent_t;
+typedef struct RingSpan RingSpan_t;
 
 struct Memory
 {
@@ -22,14 +30,14 @@ struct Texture
     uint16_t width;
     uint16_t height;
     uint8_t pixel_size_bytes;
-    uint8_t pixels[];
+    uint8_t pixels[] __attribute__((aligned(COMMON_SIMD_ALIGNMENT)));
 };
 
 struct AudioClip
 {
     uint32_t num_samples;
     uint8_t num_channels;
-    float samples[];
+    float samples[] __attribute__((aligned(COMMON_SIMD_ALIGNMENT)));
 };
 
 struct UniformRing
@@ -41,17 +49,47 @@ struct UniformRing
     uint8_t buffer[];
 };
 
+/**
+ * A contiguous view into a ring buffer's storage, 'len' units long.
+ * The live region of a ring is covered by at most two of these, split at the wrap point.
+ */
+struct RingSpan
+{
+    void *ptr;
+    uint32_t len;
+};
+
 struct InputEvent
 {
     int32_t key;
     int32_t value;
 };
 
+RING_DEFINE(InputEvent_t)
+
+/**
+ * The alpha test every blitter and the sprite run compiler share, for a texel of the given size:
+ * a palette index above 64, an RGB24 color keyed to black, or an XRGB8888 texel with a zero alpha byte.
+ * TODO: somehow move this responsibility to the platform side
+ */
+static inline bool texel_is_transparent(const uint8_t *texel, uint8_t pixel_size)
+{
+    return (pixel_size == 1 && texel[0] > 64)
+        || (pixel_size == 3 && (texel[0] + texel[1] + texel[2] <= TEXEL_KEY_SUM_MAX))
+        || (pixel_size == 4 && texel[3] == 0);
+}
+
 UniformRing_t* ring_create(uint32_t capacity, uint8_t unit_size);
 void ring_init(UniformRing_t *ring, uint32_t capacity, uint8_t unit_size);
 uint32_t ring_push(UniformRing_t *ring, void *chunk, uint32_t len, bool overwrite_on_collision);
 bool ring_pop(UniformRing_t *ring, void *out);
+uint32_t ring_pop_bulk(UniformRing_t *ring, void *out, uint32_t len);
+uint32_t ring_peek_bulk(const UniformRing_t *ring, uint32_t offset, void *out, uint32_t len);
 bool ring_peek(const UniformRing_t *ring, uint32_t offset, void *out, bool absolute);
 bool ring_peek_ptr(const UniformRing_t *ring, uint32_t offset, void **out_pptr, bool absolute);
+uint8_t ring_get_spans(const UniformRing_t *ring, RingSpan_t spans[2]);
+uint32_t ring_consume(UniformRing_t *ring, uint32_t len);
+
+void texels_rgb24_to_xrgb8888(uint32_t *dest, const uint8_t *src, size_t texel_count);
 
 #endif
@@ -0,0 +1,257 @@
+#include "common_swapchain.h"
+
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * Two presentable copies of the gfx buffer and a thread presenting them in turn.
+ *
+ * The submitting thread copies each finished frame into the next slot and moves on to the following frame,
+ * while the present thread shows the previous one. Submitting waits only if that slot is still queued or on screen.
+ * A slot last received the frame before the previous one, so it is brought up to date with the regions dirtied
+ * by both frames ('stale' tracks the former); frames that barely change cost barely any copying.
+ */
+struct Swapchain
+{
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t ready_cond;
+    pthread_cond_t free_cond;
+
+    SwapchainPresentFunc present;
+
+    /// guarded by the mutex
+    bool quit;
+    bool pending[SWAPCHAIN_SLOT_COUNT];
+    int64_t submit_us[SWAPCHAIN_SLOT_COUNT];
+    SwapchainStats_t stats;
+
+    /// written by the submitting thread only while the slot is not pending
+    Texture_t *slots[SWAPCHAIN_SLOT_COUNT];
+    GfxDirtyList_t slot_dirty[SWAPCHAIN_SLOT_COUNT];
+    GfxDirtyList_t stale[SWAPCHAIN_SLOT_COUNT];
+
+    /// the slot the submitting thread fills next
+    uint8_t write_idx;
+};
+
+static int64_t swapchain_time_us(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((int64_t)now.tv_sec * 1000000) + (now.tv_nsec / 1000);
+}
+
+static void swapchain_copy_rect(Texture_t *dest, const Texture_t *src, GfxRect_t rect)
+{
+    const size_t pixel_size = src->pixel_size_bytes;
+
+    for (int32_t y = rect.y; y < rect.y + rect.h; y++)
+    {
+        size_t offset = pixel_size * (size_t)(rect.x + (y * src->width));
+        memcpy(dest->pixels + offset, src->pixels + offset, pixel_size * rect.w);
+    }
+}
+
+/**
+ * @brief Copies the regions listed as dirty, or the whole frame if the list says so.
+ */
+static void swapchain_copy_dirty(Texture_t *dest, const Texture_t *src, const GfxDirtyList_t *dirty)
+{
+    if (dirty->full)
+    {
+        memcpy(dest->pixels, src->pixels, (size_t)src->width * src->height * src->pixel_size_bytes);
+        return;
+    }
+
+    for (uint32_t i = 0; i < dirty->count; i++)
+    {
+        swapchain_copy_rect(dest, src, dirty->rects[i]);
+    }
+}
+
+static void* swapchain_thread_func(void *arg)
+{
+    Swapchain_t *chain = (Swapchain_t *)arg;
+    uint8_t read_idx = 0;
+
+    pthread_mutex_lock(&chain->mutex);
+
+    while (true)
+    {
+        while (!chain->quit && !chain->pending[read_idx])
+        {
+            pthread_cond_wait(&chain->ready_cond, &chain->mutex);
+        }
+
+        /// frames already submitted are still presented before quitting
+        if (!chain->pending[read_idx]) break;
+
+        int64_t start_us = swapchain_time_us();
+        int64_t handoff_us = start_us - chain->submit_us[read_idx];
+        pthread_mutex_unlock(&chain->mutex);
+
+        chain->present(chain->slots[read_idx], &chain->slot_dirty[read_idx]);
+        int64_t present_us = swapchain_time_us() - start_us;
+
+        pthread_mutex_lock(&chain->mutex);
+        chain->stats.frame_count++;
+        chain->stats.handoff_us_total += handoff_us;
+        chain->stats.present_us_total += present_us;
+        if (handoff_us > chain->stats.handoff_us_max) chain->stats.handoff_us_max = handoff_us;
+
+        chain->pending[read_idx] = false;
+        pthread_cond_signal(&chain->free_cond);
+
+        read_idx = (read_idx + 1) % SWAPCHAIN_SLOT_COUNT;
+    }
+
+    pthread_mutex_unlock(&chain->mutex);
+    return NULL;
+}
+
+/**
+ * @brief Creates a swapchain of slots shaped like 'format', presented by a new thread through 'present'.
+ *
+ * @retval The swapchain, or NULL if its memory or thread could not be had.
+ */
+Swapchain_t* swapchain_create(const Texture_t *format, SwapchainPresentFunc present)
+{
+    Swapchain_t *chain = calloc(1, sizeof(Swapchain_t));
+
+    if (chain == NULL) return NULL;
+
+    chain->present = present;
+    size_t size = sizeof(Texture_t) + ((size_t)format->width * format->height * format->pixel_size_bytes);
+
+    for (uint8_t i = 0; i < SWAPCHAIN_SLOT_COUNT; i++)
+    {
+        void *slot_memory = NULL;
+
+        if (posix_memalign(&slot_memory, COMMON_SIMD_ALIGNMENT, size) != 0)
+        {
+            for (uint8_t j = 0; j < i; j++) free(chain->slots[j]);
+            free(chain);
+            return NULL;
+        }
+
+        memset(slot_memory, 0, size);
+        chain->slots[i] = (Texture_t *)slot_memory;
+        chain->slots[i]->width = format->width;
+        chain->slots[i]->height = format->height;
+        chain->slots[i]->pixel_size_bytes = format->pixel_size_bytes;
+
+        /// nothing has been copied in yet
+        gfx_dirty_reset(&chain->stale[i], true);
+    }
+
+    pthread_mutex_init(&chain->mutex, NULL);
+    pthread_cond_init(&chain->ready_cond, NULL);
+    pthread_cond_init(&chain->free_cond, NULL);
+
+    if (pthread_create(&chain->thread, NULL, swapchain_thread_func, chain) != 0)
+    {
+        pthread_cond_destroy(&chain->free_cond);
+        pthread_cond_destroy(&chain->ready_cond);
+        pthread_mutex_destroy(&chain->mutex);
+        for (uint8_t i = 0; i < SWAPCHAIN_SLOT_COUNT; i++) free(chain->slots[i]);
+        free(chain);
+        return NULL;
+    }
+
+    return chain;
+}
+
+/**
+ * @brief Presents whatever was submitted, then stops the present thread and frees the swapchain.
+ */
+void swapchain_destroy(Swapchain_t *chain)
+{
+    if (chain == NULL) return;
+
+    pthread_mutex_lock(&chain->mutex);
+    chain->quit = true;
+    pthread_cond_signal(&chain->ready_cond);
+    pthread_mutex_unlock(&chain->mutex);
+
+    pthread_join(chain->thread, NULL);
+
+    pthread_cond_destroy(&chain->free_cond);
+    pthread_cond_destroy(&chain->ready_cond);
+    pthread_mutex_destroy(&chain->mutex);
+
+    for (uint8_t i = 0; i < SWAPCHAIN_SLOT_COUNT; i++) free(chain->slots[i]);
+
+    free(chain);
+}
+
+/**
+ * @brief Queues a finished frame for presenting, given the regions it changed since the last one submitted.
+ * Returns as soon as the frame is copied, so 'frame' may be drawn into again right away.
+ */
+void swapchain_submit(Swapchain_t *chain, const Texture_t *frame, const GfxDirtyList_t *dirty)
+{
+    uint8_t idx = chain->write_idx;
+    GfxRect_t bounds = { 0, 0, frame->width, frame->height };
+    int64_t start_us = swapchain_time_us();
+
+    pthread_mutex_lock(&chain->mutex);
+
+    while (chain->pending[idx])
+    {
+        pthread_cond_wait(&chain->free_cond, &chain->mutex);
+    }
+
+    chain->stats.stall_us_total += swapchain_time_us() - start_us;
+    pthread_mutex_unlock(&chain->mutex);
+
+    /// one merged list, so that regions dirtied by both frames are copied once
+    GfxDirtyList_t *stale = &chain->stale[idx];
+    if (dirty->full) stale->full = true;
+
+    for (uint32_t r = 0; r < dirty->count; r++)
+    {
+        gfx_dirty_add(stale, dirty->rects[r], bounds);
+    }
+
+    swapchain_copy_dirty(chain->slots[idx], frame, stale);
+    chain->slot_dirty[idx] = *dirty;
+    gfx_dirty_reset(stale, false);
+
+    /// every other slot now lags behind by this frame's changes
+    for (uint8_t i = 0; i < SWAPCHAIN_SLOT_COUNT; i++)
+    {
+        if (i == idx) continue;
+
+        if (dirty->full)
+        {
+            gfx_dirty_reset(&chain->stale[i], true);
+            continue;
+        }
+
+        for (uint32_t r = 0; r < dirty->count; r++)
+        {
+            gfx_dirty_add(&chain->stale[i], dirty->rects[r], bounds);
+        }
+    }
+
+    pthread_mutex_lock(&chain->mutex);
+    chain->pending[idx] = true;
+    chain->submit_us[idx] = swapchain_time_us();
+    pthread_cond_signal(&chain->ready_cond);
+    pthread_mutex_unlock(&chain->mutex);
+
+    chain->write_idx = (idx + 1) % SWAPCHAIN_SLOT_COUNT;
+}
+
+/**
+ * @brief Copies out the timings accumulated since the last call, and starts over.
+ */
+void swapchain_take_stats(Swapchain_t *chain, SwapchainStats_t *out)
+{
+    pthread_mutex_lock(&chain->mutex);
+    *out = chain->stats;
+    memset(&chain->stats, 0, sizeof(chain->stats));
+    pthread_mutex_unlock(&chain->mutex);
+}
@@ -0,0 +1,37 @@
+#ifndef COMMON_SWAPCHAIN_H
+#define COMMON_SWAPCHAIN_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "common_structs.h"
+#include "common_rect.h"
+
+#define SWAPCHAIN_SLOT_COUNT (2)
+
+typedef struct Swapchain Swapchain_t;
+typedef struct SwapchainStats SwapchainStats_t;
+
+/// shows a finished frame, of which only the regions in 'dirty' changed since the previous one
+typedef void (*SwapchainPresentFunc)(Texture_t *frame, const GfxDirtyList_t *dirty);
+
+/// timings accumulated since they were last taken, see swapchain_take_stats()
+struct SwapchainStats
+{
+    uint32_t frame_count;
+    /// from a frame's submission until the present thread picked it up
+    int64_t handoff_us_total;
+    int64_t handoff_us_max;
+    /// spent inside the present function
+    int64_t present_us_total;
+    /// spent by the submitting thread waiting for a free slot
+    int64_t stall_us_total;
+};
+
+Swapchain_t* swapchain_create(const Texture_t *format, SwapchainPresentFunc present);
+void swapchain_destroy(Swapchain_t *chain);
+void swapchain_submit(Swapchain_t *chain, const Texture_t *frame, const GfxDirtyList_t *dirty);
+void swapchain_take_stats(Swapchain_t *chain, SwapchainStats_t *out);
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef COMMON_TYPED_RING_H
+#define COMMON_TYPED_RING_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/**
+ * Compile-time specialized ring buffers.
+ *
+ * RING_DEFINE(T) generates the type Ring_T and the functions ring_T_<op>() for element type T,
+ * where T must be a single identifier (use a typedef for anything else).
+ * Since the element size is known at compile time, copies become plain typed loads and stores,
+ * and the power-of-two capacity turns every wrap into a mask.
+ * The runtime-sized UniformRing_t remains available for anything else.
+ */
+
+#define RING_TYPE(T) Ring_##T
+
+/**
+ * @brief Returns the smallest power of two greater than or equal to the given capacity.
+ */
+static inline uint32_t ring_capacity_pow2(uint32_t capacity)
+{
+    uint32_t rounded = 1;
+
+    while (rounded < capacity && rounded < 0x80000000u)
+    {
+        rounded <<= 1;
+    }
+
+    return rounded;
+}
+
+#define RING_DEFINE(T) \
+\
+typedef struct Ring_##T \
+{ \
+    uint32_t capacity; \
+    uint32_t mask; \
+    uint32_t head; \
+    uint32_t length; \
+    T buffer[]; \
+} Ring_##T; \
+\
+static inline size_t ring_##T##_required_bytes(uint32_t capacity) \
+{ \
+    return sizeof(Ring_##T) + ((size_t)ring_capacity_pow2(capacity) * sizeof(T)); \
+} \
+\
+static inline void ring_##T##_init(Ring_##T *ring, uint32_t capacity) \
+{ \
+    ring->capacity = ring_capacity_pow2(capacity); \
+    ring->mask = ring->capacity - 1; \
+    ring->head = 0; \
+    ring->length = 0; \
+    memset(ring->buffer, 0, (size_t)ring->capacity * sizeof(T)); \
+} \
+\
+static inline Ring_##T* ring_##T##_create(uint32_t capacity) \
+{ \
+    Ring_##T *ring = (Ring_##T *)malloc(ring_##T##_required_bytes(capacity)); \
+    if (ring != NULL) ring_##T##_init(ring, capacity); \
+    return ring; \
+} \
+\
+/** Same contract as ring_push(): returns the number of items consumed from 'items'. */ \
+static inline uint32_t ring_##T##_push(Ring_##T *ring, const T *items, uint32_t len, bool overwrite_on_collision) \
+{ \
+    uint32_t free_count = ring->capacity - ring->length; \
+    uint32_t pushed_count = len; \
+\
+    if (len > free_count) \
+    { \
+        if (!overwrite_on_collision) \
+        { \
+            len = free_count; \
+            pushed_count = len; \
+        } \
+        else \
+        { \
+            if (len > ring->capacity) \
+            { \
+                items += len - ring->capacity; \
+                len = ring->capacity; \
+            } \
+            ring->head = (ring->head + (len - free_count)) & ring->mask; \
+            ring->length -= len - free_count; \
+        } \
+    } \
+\
+    uint32_t start_idx = (ring->head + ring->length) & ring->mask; \
+    uint32_t first_len = ring->capacity - start_idx; \
+    if (first_len > len) first_len = len; \
+\
+    for (uint32_t i = 0; i < first_len; i++) ring->buffer[start_idx + i] = items[i]; \
+    for (uint32_t i = first_len; i < len; i++) ring->buffer[i - first_len] = items[i]; \
+\
+    ring->length += len; \
+    return pushed_count; \
+} \
+\
+/** Same contract as ring_pop_bulk(): returns the number of items popped. */ \
+static inline uint32_t ring_##T##_pop(Ring_##T *ring, T *out, uint32_t len) \
+{ \
+    if (len > ring->length) len = ring->length; \
+\
+    uint32_t first_len = ring->capacity - ring->head; \
+    if (first_len > len) first_len = len; \
+\
+    for (uint32_t i = 0; i < first_len; i++) out[i] = ring->buffer[ring->head + i]; \
+    for (uint32_t i = first_len; i < len; i++) out[i] = ring->buffer[i - first_len]; \
+\
+    ring->head = (ring->head + len) & ring->mask; \
+    ring->length -= len; \
+    return len; \
+} \
+\
+/** Same contract as ring_peek() with a head-relative offset. */ \
+static inline bool ring_##T##_peek(const Ring_##T *ring, uint32_t offset, T *out) \
+{ \
+    *out = ring->buffer[(ring->head + offset) & ring->mask]; \
+    return offset < ring->length; \
+}
+
+#endif
@@ -0,0 +1,201 @@
+#include "common_workers.h"
+
+#include <pthread.h>
+
+/**
+ * A persistent pool of threads for parallel-for batches.
+ *
+ * The calling thread publishes a batch by bumping 'generation' under the mutex and works on it too;
+ * every thread then claims job indices with an atomic increment until none are left.
+ * The caller returns once all jobs have finished and no worker is still inside the batch.
+ * A worker may still wake for a batch after its caller returned, so each worker copies the batch under the mutex,
+ * and the next batch is only published once no worker is active; such a late worker then finds no job left to claim,
+ * so 'func' and 'context' need only live for the duration of workers_run().
+ */
+struct WorkerPool
+{
+    pthread_mutex_t mutex;
+    pthread_cond_t start_cond;
+    pthread_cond_t done_cond;
+
+    /// guarded by the mutex
+    uint64_t generation;
+    uint8_t active_count;
+    bool quit;
+
+    /// the current batch, written before its generation is published
+    WorkerJobFunc func;
+    void *context;
+    uint32_t job_count;
+
+    /// claimed and finished job counts of the current batch
+    uint32_t next_job;
+    uint32_t done_count;
+
+    uint8_t thread_count;
+    pthread_t threads[WORKERS_THREADS_MAX];
+};
+
+/**
+ * @brief Claims and runs jobs of the current batch until none are left.
+ * Signals the caller if it finished the last one.
+ */
+static void workers_drain(WorkerPool_t *pool, WorkerJobFunc func, void *context, uint32_t job_count)
+{
+    uint32_t finished = 0;
+    uint32_t job_idx;
+
+    while ((job_idx = __atomic_fetch_add(&pool->next_job, 1, __ATOMIC_RELAXED)) < job_count)
+    {
+        func(context, job_idx);
+        finished++;
+    }
+
+    if (finished > 0
+        && __atomic_add_fetch(&pool->done_count, finished, __ATOMIC_ACQ_REL) == job_count)
+    {
+        pthread_mutex_lock(&pool->mutex);
+        pthread_cond_signal(&pool->done_cond);
+        pthread_mutex_unlock(&pool->mutex);
+    }
+}
+
+static void* workers_thread_func(void *arg)
+{
+    WorkerPool_t *pool = (WorkerPool_t *)arg;
+    uint64_t seen_generation = 0;
+
+    pthread_mutex_lock(&pool->mutex);
+
+    while (true)
+    {
+        while (!pool->quit && pool->generation == seen_generation)
+        {
+            pthread_cond_wait(&pool->start_cond, &pool->mutex);
+        }
+
+        if (pool->quit) break;
+
+        seen_generation = pool->generation;
+        pool->active_count++;
+
+        WorkerJobFunc func = pool->func;
+        void *context = pool->context;
+        uint32_t job_count = pool->job_count;
+
+        pthread_mutex_unlock(&pool->mutex);
+
+        workers_drain(pool, func, context, job_count);
+
+        pthread_mutex_lock(&pool->mutex);
+        pool->active_count--;
+
+        if (pool->active_count == 0) pthread_cond_signal(&pool->done_cond);
+    }
+
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+/**
+ * @brief Creates a pool running batches on 'thread_count' threads in total, the calling one included,
+ * so a count of 1 (or a failure to start any threads) runs every batch serially.
+ *
+ * @retval The pool, or NULL if it could not be allocated.
+ */
+WorkerPool_t* workers_create(uint8_t thread_count)
+{
+    WorkerPool_t *pool = calloc(1, sizeof(WorkerPool_t));
+
+    if (pool == NULL) return NULL;
+
+    if (thread_count < 1) thread_count = 1;
+    if (thread_count > WORKERS_THREADS_MAX) thread_count = WORKERS_THREADS_MAX;
+
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->start_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+
+    /// slot 0 stands for the calling thread
+    pool->thread_count = 1;
+
+    while (pool->thread_count < thread_count
+        && pthread_create(&pool->threads[pool->thread_count], NULL, workers_thread_func, pool) == 0)
+    {
+        pool->thread_count++;
+    }
+
+    return pool;
+}
+
+void workers_destroy(WorkerPool_t *pool)
+{
+    if (pool == NULL) return;
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->quit = true;
+    pthread_cond_broadcast(&pool->start_cond);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (uint8_t i = 1; i < pool->thread_count; i++)
+    {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_cond_destroy(&pool->start_cond);
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool);
+}
+
+uint8_t workers_get_thread_count(const WorkerPool_t *pool)
+{
+    return pool == NULL ? 1 : pool->thread_count;
+}
+
+/**
+ * @brief Runs func(context, i) for every i below 'job_count' across the pool, and returns once all have finished.
+ * Jobs may run in any order and on any thread, including the caller's. Must not be called from within a job.
+ */
+void workers_run(WorkerPool_t *pool, WorkerJobFunc func, void *context, uint32_t job_count)
+{
+    if (job_count == 0) return;
+
+    if (pool == NULL || pool->thread_count <= 1 || job_count == 1)
+    {
+        for (uint32_t i = 0; i < job_count; i++)
+        {
+            func(context, i);
+        }
+
+        return;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+
+    /// a worker that woke late for the previous batch must be out of it before its fields are reused
+    while (pool->active_count > 0)
+    {
+        pthread_cond_wait(&pool->done_cond, &pool->mutex);
+    }
+
+    pool->func = func;
+    pool->context = context;
+    pool->job_count = job_count;
+    pool->next_job = 0;
+    pool->done_count = 0;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start_cond);
+    pthread_mutex_unlock(&pool->mutex);
+
+    workers_drain(pool, func, context, job_count);
+
+    pthread_mutex_lock(&pool->mutex);
+
+    while (__atomic_load_n(&pool->done_count, __ATOMIC_ACQUIRE) < job_count || pool->active_count > 0)
+    {
+        pthread_cond_wait(&pool->done_cond, &pool->mutex);
+    }
+
+    pthread_mutex_unlock(&pool->mutex);
+}
@@ -0,0 +1,20 @@
+#ifndef COMMON_WORKERS_H
+#define COMMON_WORKERS_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define WORKERS_THREADS_MAX (16)
+
+typedef struct WorkerPool WorkerPool_t;
+
+/// one job of a parallel batch, called once for every index from 0 up to the batch's job count
+typedef void (*WorkerJobFunc)(void *context, uint32_t job_idx);
+
+WorkerPool_t* workers_create(uint8_t thread_count);
+void workers_destroy(WorkerPool_t *pool);
+uint8_t workers_get_thread_count(const WorkerPool_t *pool);
+void workers_run(WorkerPool_t *pool, WorkerJobFunc func, void *context, uint32_t job_count);
+
+#endif
@@ -2,9 +2,15 @@
 #include "softcover_utils.h"
 #include "softcover_ncurses.h"
 
+#include <pthread.h>
+
 static bool debug_is_break = false;
 static DebugRing_t debug_ring = {0};
 
+/// messages may come from worker threads, such as the app's asset loads, see debug_log()
+static pthread_mutex_t debug_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t debug_main_thread;
+
 void debug_dump_log(void)
 {
     char buff[DEBUG_MESSAGE_MAX_LEN] = {0};
@@ -27,8 +33,14 @@ void debug_dump_log(void)
     }
 }
 
+/**
+ * @brief Records a message and shows it; safe to call from any thread,
+ * though only the main thread draws the log, others leave their messages to the next dump.
+ */
 void debug_log(char *message)
 {
+    pthread_mutex_lock(&debug_mutex);
+
     uint8_t idx = debug_ring.head + debug_ring.len % DEBUG_RING_CAPACITY;
     snprintf(debug_ring.debug_messages[idx], DEBUG_MESSAGE_MAX_LEN, "%s", message);
 
@@ -44,12 +56,14 @@ void debug_log(char *message)
 
     if (gfx_is_initialized())
     {
-        debug_dump_log();
+        if (pthread_equal(pthread_self(), debug_main_thread)) debug_dump_log();
     }
     else
     {
         printf("DEBUG: %s\n", message);
     }
+
+    pthread_mutex_unlock(&debug_mutex);
 }
 
 void debug_break(void)
@@ -77,4 +91,5 @@ void debug_init(void)
 {
     debug_ring.head = 0;
     debug_ring.len = 0;
+    debug_main_thread = pthread_self();
 }
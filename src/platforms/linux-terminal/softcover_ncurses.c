@@ -1,13 +1,64 @@
+/// for fopencookie()
+#define _GNU_SOURCE
+
 #include "softcover_ncurses.h"
 #include "softcover_utils.h"
 #include "softcover_debug.h"
 #include "softcover_time.h"
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 static WINDOW *main_window = NULL;
 static WINDOW *debug_window = NULL;
 
+/// ncurses writes the terminal through this stream, which counts the bytes on their way to stdout
+static SCREEN *terminal_screen = NULL;
+static FILE *terminal_output = NULL;
+static char terminal_output_buffer[TERMINAL_OUTPUT_BUFFER_BYTES];
+static uint64_t terminal_output_bytes = 0;
+
+/// the color pair last written to each cell of the main window, CELL_UNKNOWN where that is not known
+static uint8_t *shown_cells = NULL;
+static uint16_t shown_width = 0;
+static uint16_t shown_height = 0;
+/// set along with forgetting the shown cells, as cells outside of the next dirty regions may be stale as well
+static bool shown_invalidated = false;
+
+/**
+ * With a truecolor terminal the main window is not drawn through ncurses at all:
+ * each cell shows two vertically stacked pixels as an upper half block, the top one as its foreground
+ * and the bottom one as its background, written with 24-bit color escapes. ncurses still owns input
+ * and the debug window, and is told nothing of these cells, see gfx_sync_truecolor().
+ */
+static bool truecolor_active = false;
+/// the top and bottom colors last written to each cell, TRUECOLOR_UNKNOWN where that is not known
+static uint32_t *shown_colors = NULL;
+/// the buffer pixel shown at the top half of the top-left cell
+static int32_t truecolor_origin_x = 0;
+static int32_t truecolor_origin_y = 0;
+/// a whole frame's escapes, handed to the terminal with a single write
+static char *truecolor_output = NULL;
+
+/// where the terminal's cursor and colors are while a frame's escapes are put together, -1 where unknown
+typedef struct TruecolorWriter
+{
+    char *out;
+    int32_t cursor_row;
+    int32_t cursor_col;
+    uint32_t fg;
+    uint32_t bg;
+} TruecolorWriter_t;
+
+static char fps_text[16] = "";
+static int64_t fps_updated_us = 0;
+
+static uint32_t output_report_frames = 0;
+static uint32_t output_report_skipped = 0;
+static uint64_t output_report_bytes = 0;
+
 #define COLOR_PAIR_BG_BLACK (0)
 #define COLOR_PAIR_BG_RED (1)
 #define COLOR_PAIR_BG_GREEN (2)
@@ -39,9 +90,25 @@ GfxDebugMode_t gfx_get_debug_mode(void)
     return gfx_debug_mode;
 }
 
+/**
+ * @brief Forgets what the main window shows, so the next sync rewrites every cell,
+ * for when something other than gfx_sync_buffer() may have drawn over it.
+ */
+static void gfx_invalidate_shown(void)
+{
+    if (shown_cells != NULL) memset(shown_cells, CELL_UNKNOWN, (size_t)shown_width * shown_height);
+    if (shown_colors != NULL) memset(shown_colors, 0xFF, 2 * sizeof(uint32_t) * shown_width * shown_height);
+    if (main_window != NULL) touchwin(main_window);
+    shown_invalidated = true;
+
+    /// ncurses believes the debug window's cells to be blank where the main window was drawn, so it must redraw them all
+    if (truecolor_active && debug_window != NULL) redrawwin(debug_window);
+}
+
 void gfx_toggle_debug_mode(void)
 {
     gfx_debug_mode = (gfx_debug_mode + 1) % GFX_DEBUG_MAXVAL;
+    gfx_invalidate_shown();
 
     switch(gfx_debug_mode)
     {
@@ -157,46 +224,387 @@ int input_read(void)
     }
 }
 
-void input_push_to_buffer(PlatformSettings_t *settings, UniformRing_t *input_buffer)
+void input_push_to_buffer(PlatformSettings_t *settings, Ring_InputEvent_t *input_buffer)
 {
+    /// the terminal only reports key presses (and their auto-repeat),
+    /// so a key that stops arriving is reported as released on the following poll.
+    static int held_keys[INPUT_POLL_MAX_KEYS] = {0};
+    static uint8_t held_count = 0;
+
+    int pressed_keys[INPUT_POLL_MAX_KEYS];
+    uint8_t pressed_count = 0;
+
+    InputEvent_t batch[INPUT_POLL_MAX_KEYS * 2];
+    uint32_t batch_len = 0;
+
     int c = '~';
 
-    for (uint8_t i = 0; i < 8; i++)
+    for (uint8_t i = 0; i < INPUT_POLL_MAX_KEYS; i++)
     {
         c = input_read();
-        if (c == '~') continue;
+        if (c == '~' || c == ERR) continue;
         if (c == KEY_LEFT)
         {
             gfx_toggle_debug_mode();
             continue;
         }
-        ring_push(input_buffer, &c, 1, false);
+
+        batch[batch_len].key = c;
+        batch[batch_len].value = 1;
+        batch_len++;
+
+        pressed_keys[pressed_count++] = c;
+    }
+
+    for (uint8_t i = 0; i < held_count; i++)
+    {
+        bool still_pressed = false;
+
+        for (uint8_t j = 0; j < pressed_count; j++)
+        {
+            if (pressed_keys[j] == held_keys[i])
+            {
+                still_pressed = true;
+                break;
+            }
+        }
+
+        if (!still_pressed)
+        {
+            batch[batch_len].key = held_keys[i];
+            batch[batch_len].value = 0;
+            batch_len++;
+        }
+    }
+
+    memcpy(held_keys, pressed_keys, pressed_count * sizeof(int));
+    held_count = pressed_count;
+
+    if (batch_len > 0)
+    {
+        ring_InputEvent_t_push(input_buffer, batch, batch_len, false);
     }
 }
 
-void gfx_sync_buffer(Texture_t *gfx_buffer)
+/**
+ * @brief Passes ncurses' output on to stdout, counting it.
+ * Must match the cookie_write_function_t prototype.
+ */
+static ssize_t terminal_output_write(void *cookie, const char *buf, size_t size)
 {
-    werase(main_window);
+    (void)cookie;
+    size_t written = 0;
 
-    for (int y = 0; y < gfx_buffer->height; y++)
+    while (written < size)
     {
-        for(int x = 0; x < gfx_buffer->width; x++)
+        ssize_t result = write(STDOUT_FILENO, buf + written, size - written);
+
+        if (result <= 0) break;
+
+        written += result;
+    }
+
+    terminal_output_bytes += written;
+    return written;
+}
+
+/**
+ * @brief Writes the cells of a rectangle that differ from what the window shows,
+ * each horizontal run of one color with a single call.
+ *
+ * @retval The number of cells written.
+ */
+static uint32_t gfx_sync_rect(Texture_t *gfx_buffer, GfxRect_t rect)
+{
+    uint32_t written_count = 0;
+
+    for (int32_t y = rect.y; y < rect.y + rect.h; y++)
+    {
+        const uint8_t *row = gfx_buffer->pixels + (y * gfx_buffer->width);
+        uint8_t *shown_row = shown_cells + (y * shown_width);
+        int32_t x = rect.x;
+
+        while (x < rect.x + rect.w)
         {
-            uint8_t val = gfx_buffer->pixels[x + (y * gfx_buffer->width)];
+            if (row[x] == shown_row[x])
+            {
+                x++;
+                continue;
+            }
 
-            wattron(main_window, COLOR_PAIR(val));
-            mvwaddch(main_window, y, x, ' ');
-            wattroff(main_window, COLOR_PAIR(val));
+            int32_t run_start = x;
+            uint8_t val = row[x];
+
+            while (x < rect.x + rect.w && row[x] == val && shown_row[x] != val)
+            {
+                shown_row[x] = val;
+                x++;
+            }
+
+            mvwhline(main_window, y, run_start, ' ' | COLOR_PAIR(val), x - run_start);
+            written_count += x - run_start;
         }
     }
 
-    float fps = 1000000.0f / time_get_delta_us();
-    mvwprintw(main_window, 0, 84, "%.2f fps\n", fps);
+    return written_count;
+}
 
-    wrefresh(main_window);
+/**
+ * @brief Logs how many bytes the terminal was sent per frame, every GFX_OUTPUT_REPORT_FRAMES frames.
+ */
+static void gfx_report_output(uint64_t frame_bytes, bool skipped)
+{
+    output_report_frames++;
+    output_report_bytes += frame_bytes;
+    if (skipped) output_report_skipped++;
+
+    if (output_report_frames < GFX_OUTPUT_REPORT_FRAMES) return;
+
+    static char report_buff[DEBUG_MESSAGE_MAX_LEN];
+    snprintf(report_buff, sizeof(report_buff), "Terminal output: %lu bytes per frame on average, %u of %u frames unchanged.",
+            output_report_bytes / output_report_frames, output_report_skipped, output_report_frames);
+    debug_log(report_buff);
+
+    output_report_frames = 0;
+    output_report_skipped = 0;
+    output_report_bytes = 0;
+}
+
+static void truecolor_put_text(TruecolorWriter_t *writer, const char *text, size_t len)
+{
+    memcpy(writer->out, text, len);
+    writer->out += len;
 }
 
-void gfx_audio_vis(const UniformRing_t *audio_buffer, const PlatformSettings_t *settings, float volume)
+/// decimal, without the cost of a formatted print per number
+static void truecolor_put_number(TruecolorWriter_t *writer, uint32_t value)
+{
+    char digits[10];
+    uint8_t count = 0;
+
+    do
+    {
+        digits[count++] = '0' + (value % 10);
+        value /= 10;
+    }
+    while (value > 0);
+
+    while (count > 0)
+    {
+        *writer->out++ = digits[--count];
+    }
+}
+
+/// moves the cursor to a zero-based cell position
+static void truecolor_put_cursor(TruecolorWriter_t *writer, int32_t row, int32_t col)
+{
+    truecolor_put_text(writer, "\x1b[", 2);
+    truecolor_put_number(writer, row + 1);
+    *writer->out++ = ';';
+    truecolor_put_number(writer, col + 1);
+    *writer->out++ = 'H';
+
+    writer->cursor_row = row;
+    writer->cursor_col = col;
+}
+
+/// 'layer' is '3' for the foreground, '4' for the background
+static void truecolor_put_color(TruecolorWriter_t *writer, char layer, uint32_t color)
+{
+    *writer->out++ = '\x1b';
+    *writer->out++ = '[';
+    *writer->out++ = layer;
+    truecolor_put_text(writer, "8;2;", 4);
+    truecolor_put_number(writer, (color >> 16) & 0xFF);
+    *writer->out++ = ';';
+    truecolor_put_number(writer, (color >> 8) & 0xFF);
+    *writer->out++ = ';';
+    truecolor_put_number(writer, color & 0xFF);
+    *writer->out++ = 'm';
+}
+
+/**
+ * @brief Writes one cell showing a top and a bottom color, moving the cursor there
+ * and changing either color only if the previous cell did not leave them so.
+ */
+static void truecolor_put_cell(TruecolorWriter_t *writer, int32_t row, int32_t col, uint32_t top, uint32_t bottom)
+{
+    if (writer->cursor_row != row || writer->cursor_col != col) truecolor_put_cursor(writer, row, col);
+
+    /// a cell of one color is a blank on that background, whatever the foreground
+    if (top == bottom)
+    {
+        if (writer->bg != bottom) truecolor_put_color(writer, '4', bottom);
+        writer->bg = bottom;
+        *writer->out++ = ' ';
+    }
+    else
+    {
+        if (writer->fg != top) truecolor_put_color(writer, '3', top);
+        if (writer->bg != bottom) truecolor_put_color(writer, '4', bottom);
+        writer->fg = top;
+        writer->bg = bottom;
+        /// U+2580 UPPER HALF BLOCK
+        truecolor_put_text(writer, "\xe2\x96\x80", 3);
+    }
+
+    /// past the last column the terminal may or may not have wrapped
+    writer->cursor_col = col + 1 < COLS ? col + 1 : -1;
+}
+
+/**
+ * @brief Writes the cells covering a rectangle of buffer pixels that differ from what they show.
+ *
+ * @retval The number of cells written.
+ */
+static uint32_t gfx_sync_truecolor_rect(TruecolorWriter_t *writer, Texture_t *gfx_buffer, GfxRect_t rect)
+{
+    int32_t col_start = rect.x - truecolor_origin_x;
+    int32_t col_end = col_start + rect.w;
+    int32_t row_start = (rect.y - truecolor_origin_y) >> 1;
+    int32_t row_end = (rect.y + rect.h - truecolor_origin_y + 1) >> 1;
+    uint32_t written_count = 0;
+
+    if (col_start < 0) col_start = 0;
+    if (row_start < 0) row_start = 0;
+    if (col_end > main_window_current_width) col_end = main_window_current_width;
+    if (row_end > main_window_current_height) row_end = main_window_current_height;
+
+    for (int32_t row = row_start; row < row_end; row++)
+    {
+        const uint32_t *top_row = (const uint32_t *)gfx_buffer->pixels
+            + (truecolor_origin_x + ((truecolor_origin_y + (2 * row)) * gfx_buffer->width));
+        const uint32_t *bottom_row = top_row + gfx_buffer->width;
+        uint32_t *shown_row = shown_colors + (2 * row * shown_width);
+
+        for (int32_t col = col_start; col < col_end; col++)
+        {
+            uint32_t top = top_row[col] & 0xFFFFFF;
+            uint32_t bottom = bottom_row[col] & 0xFFFFFF;
+
+            if (shown_row[2 * col] == top && shown_row[(2 * col) + 1] == bottom) continue;
+
+            truecolor_put_cell(writer, row, col, top, bottom);
+            shown_row[2 * col] = top;
+            shown_row[(2 * col) + 1] = bottom;
+            written_count++;
+        }
+    }
+
+    return written_count;
+}
+
+/**
+ * @brief Writes the cells that changed since the last sync as one run of escapes, sent with a single write.
+ *
+ * @details
+ * Cursor moves are only written where the changed cells are not contiguous, and colors only where they change.
+ * The frame ends by resetting the colors and putting the cursor back where ncurses left it,
+ * so that ncurses' own output for the debug window lands where it expects.
+ *
+ * @retval Whether anything was written.
+ */
+static bool gfx_sync_truecolor(Texture_t *gfx_buffer, const GfxDirtyList_t *dirty, bool fps_changed)
+{
+    TruecolorWriter_t writer = { truecolor_output, -1, -1, TRUECOLOR_UNKNOWN, TRUECOLOR_UNKNOWN };
+    GfxRect_t bounds = { 0, 0, gfx_buffer->width, gfx_buffer->height };
+    uint32_t written_count = 0;
+
+    if (dirty == NULL || dirty->full)
+    {
+        written_count += gfx_sync_truecolor_rect(&writer, gfx_buffer, bounds);
+    }
+    else
+    {
+        for (uint32_t i = 0; i < dirty->count; i++)
+        {
+            written_count += gfx_sync_truecolor_rect(&writer, gfx_buffer, rect_intersect(dirty->rects[i], bounds));
+        }
+    }
+
+    if (written_count == 0 && !fps_changed) return false;
+
+    truecolor_put_text(&writer, "\x1b[0m", 4);
+
+    if (main_window_current_width > 84 + (int32_t)strlen(fps_text))
+    {
+        truecolor_put_cursor(&writer, 0, 84);
+        truecolor_put_text(&writer, fps_text, strlen(fps_text));
+    }
+
+    int cursor_row, cursor_col;
+    getyx(curscr, cursor_row, cursor_col);
+    truecolor_put_cursor(&writer, cursor_row, cursor_col);
+
+    /// whatever ncurses still holds goes out first
+    if (terminal_output != NULL) fflush(terminal_output);
+    terminal_output_write(NULL, truecolor_output, writer.out - truecolor_output);
+
+    return true;
+}
+
+/**
+ * @brief Writes the cells that changed since the last sync, looking only within the dirty regions
+ * (or the whole buffer if the list says so), and refreshes the terminal only if anything did.
+ */
+void gfx_sync_buffer(Texture_t *gfx_buffer, const GfxDirtyList_t *dirty)
+{
+    /// the counter changes every frame, so it is only updated every so often lest it alone keeps the terminal busy
+    int64_t now_us = time_get_monotonic_us();
+    bool fps_changed = false;
+
+    if (now_us - fps_updated_us >= GFX_FPS_UPDATE_US)
+    {
+        char text[sizeof(fps_text)];
+        snprintf(text, sizeof(text), "%8.2f fps", 1000000.0f / time_get_delta_us());
+        fps_changed = strcmp(text, fps_text) != 0;
+        memcpy(fps_text, text, sizeof(fps_text));
+        fps_updated_us = now_us;
+    }
+
+    uint64_t bytes_before = terminal_output_bytes;
+
+    if (shown_invalidated)
+    {
+        dirty = NULL;
+        shown_invalidated = false;
+    }
+
+    if (truecolor_active)
+    {
+        bool skipped = !gfx_sync_truecolor(gfx_buffer, dirty, fps_changed);
+        gfx_report_output(terminal_output_bytes - bytes_before, skipped);
+        return;
+    }
+
+    GfxRect_t bounds = { 0, 0, shown_width, shown_height };
+    uint32_t written_count = 0;
+
+    if (dirty == NULL || dirty->full)
+    {
+        written_count += gfx_sync_rect(gfx_buffer, bounds);
+    }
+    else
+    {
+        for (uint32_t i = 0; i < dirty->count; i++)
+        {
+            written_count += gfx_sync_rect(gfx_buffer, rect_intersect(dirty->rects[i], bounds));
+        }
+    }
+
+    bool skipped = written_count == 0 && !fps_changed;
+
+    if (!skipped)
+    {
+        /// fixed width and no newline, written over any cells just rewritten beneath it
+        mvwprintw(main_window, 0, 84, "%s", fps_text);
+        wrefresh(main_window);
+    }
+
+    gfx_report_output(terminal_output_bytes - bytes_before, skipped);
+}
+
+void gfx_audio_vis(const SpscRing_t *audio_buffer, const PlatformSettings_t *settings, float volume)
 {
     werase(debug_window);
 
@@ -204,18 +612,25 @@ void gfx_audio_vis(const UniformRing_t *audio_buffer, const PlatformSettings_t *
     float min_val = 0.0f;
     float max_abs_val = 0.0f;
 
-    for(uint32_t i = 0; i < audio_buffer->capacity; i++)
+    /// walk the live samples in place rather than copying them out one by one
+    RingSpan_t spans[2];
+    uint8_t span_count = spsc_read_spans(audio_buffer, spans);
+
+    for (uint8_t s = 0; s < span_count; s++)
     {
-        float temp_val = 0.0f;
-        ring_peek(audio_buffer, i, &temp_val, true);
-        if (temp_val > max_val) max_val = temp_val;
-        else if (temp_val < min_val) min_val = temp_val;
+        const float *samples = (const float *)spans[s].ptr;
+
+        for(uint32_t i = 0; i < spans[s].len; i++)
+        {
+            if (samples[i] > max_val) max_val = samples[i];
+            else if (samples[i] < min_val) min_val = samples[i];
+        }
     }
 
     max_abs_val = max_val;
     if (min_val < 0.0f && min_val * -1.0f > max_val) max_abs_val = min_val * -1.0f;
 
-    float norm = ((float)audiovis_mid_row * 0.5f) / max_abs_val;
+    float norm = max_abs_val > 0.0f ? ((float)audiovis_mid_row * 0.5f) / max_abs_val : 0.0f;
 
     mvwprintw(debug_window, 0, 0, "Min: %f Max: %f", min_val, max_val);
 
@@ -241,7 +656,15 @@ void gfx_audio_vis(const UniformRing_t *audio_buffer, const PlatformSettings_t *
 
             float val = 0.0f;
 
-            if (!ring_peek(audio_buffer, count, &val, false))
+            if (count < spans[0].len)
+            {
+                val = ((const float *)spans[0].ptr)[count];
+            }
+            else if (count - spans[0].len < spans[1].len)
+            {
+                val = ((const float *)spans[1].ptr)[count - spans[0].len];
+            }
+            else
             {
                 silence = true;
             }
@@ -279,11 +702,11 @@ void gfx_audio_vis(const UniformRing_t *audio_buffer, const PlatformSettings_t *
     wrefresh(debug_window);
 }
 
-void input_init(PlatformSettings_t *settings, UniformRing_t **input_buffer_pptr)
+void input_init(PlatformSettings_t *settings, Ring_InputEvent_t **input_buffer_pptr)
 {
     keypad(main_window, true);
     /// init input buffer
-    *input_buffer_pptr = ring_create(settings->input_buffer_capacity, sizeof(int));
+    *input_buffer_pptr = ring_InputEvent_t_create(settings->input_buffer_capacity);
 }
 
 bool gfx_is_initialized(void)
@@ -291,27 +714,121 @@ bool gfx_is_initialized(void)
     return ncurses_is_initialized;
 }
 
-void gfx_init(PlatformSettings_t *settings, Texture_t **gfx_buffer_pptr)
+/**
+ * @brief Whether the terminal says it takes 24-bit color escapes, as terminals that do set COLORTERM.
+ */
+static bool gfx_terminal_has_truecolor(void)
 {
-    /// init gfx buffer
-    *gfx_buffer_pptr = (Texture_t *)malloc(sizeof(Texture_t) +
-    (settings->gfx_buffer_width * settings->gfx_buffer_height * settings->gfx_pixel_size_bytes));
+    const char *colorterm = getenv("COLORTERM");
+
+    return colorterm != NULL && (strcmp(colorterm, "truecolor") == 0 || strcmp(colorterm, "24bit") == 0);
+}
+
+bool gfx_init(PlatformSettings_t *settings, Texture_t **gfx_buffer_pptr)
+{
+    /// anything but color pairs is drawn in 24-bit color, if the terminal takes it
+    if (settings->gfx_pixel_format != PIXEL_FORMAT_INDEX8 && !gfx_terminal_has_truecolor())
+    {
+        debug_log("Terminal does not report truecolor support, using 8 color pairs.");
+        settings->gfx_pixel_format = PIXEL_FORMAT_INDEX8;
+    }
+
+    truecolor_active = settings->gfx_pixel_format != PIXEL_FORMAT_INDEX8;
+    if (truecolor_active) settings->gfx_pixel_format = PIXEL_FORMAT_XRGB8888;
+
+    settings->gfx_pixel_size_bytes = pixel_format_size_bytes(settings->gfx_pixel_format);
+    gfx_set_texture_format(settings->gfx_pixel_format);
+
+    /// init gfx buffer, aligned like every other Texture_t's pixels
+    void *gfx_buffer_memory = NULL;
+
+    if (posix_memalign(&gfx_buffer_memory, COMMON_SIMD_ALIGNMENT, sizeof(Texture_t) +
+        (settings->gfx_buffer_width * settings->gfx_buffer_height * settings->gfx_pixel_size_bytes)) != 0)
+    {
+        debug_log("Could not allocate the gfx buffer.");
+        *gfx_buffer_pptr = NULL;
+        return false;
+    }
+
+    *gfx_buffer_pptr = (Texture_t *)gfx_buffer_memory;
     Texture_t *gfx_buffer = (Texture_t *)*gfx_buffer_pptr;
     memset(gfx_buffer, 0, sizeof(*gfx_buffer));
     gfx_buffer->width = settings->gfx_buffer_width;
     gfx_buffer->height = settings->gfx_buffer_height;
     gfx_buffer->pixel_size_bytes = settings->gfx_pixel_size_bytes;
 
-    /// init ncurses
+    /// init ncurses, writing through the counting stream if it can be had
+
+    cookie_io_functions_t output_functions = { .write = terminal_output_write };
+    terminal_output = fopencookie(NULL, "w", output_functions);
+
+    if (terminal_output != NULL)
+    {
+        /// fully buffered, so a refresh reaches the terminal in as few writes as possible
+        setvbuf(terminal_output, terminal_output_buffer, _IOFBF, sizeof(terminal_output_buffer));
+        terminal_screen = newterm(NULL, terminal_output, stdin);
+    }
+
+    if (terminal_screen == NULL)
+    {
+        initscr();
+    }
 
-    initscr();
     noecho();
     cbreak();
 
     gfx_debug_mode = GFX_DEBUG_NONE;
 
-    main_window_full_width =     settings->gfx_buffer_width;
-    main_window_full_height =    settings->gfx_buffer_height;
+    if (truecolor_active)
+    {
+        /// as many cells as the terminal has, two buffer rows to each, around the middle of the buffer
+        int32_t cols = COLS < (int32_t)settings->gfx_buffer_width ? COLS : (int32_t)settings->gfx_buffer_width;
+        int32_t rows = LINES < (int32_t)(settings->gfx_buffer_height / 2) ? LINES : (int32_t)(settings->gfx_buffer_height / 2);
+        if (cols > UINT8_MAX) cols = UINT8_MAX;
+        if (rows > UINT8_MAX) rows = UINT8_MAX;
+
+        truecolor_origin_x = (settings->gfx_buffer_width - cols) / 2;
+        truecolor_origin_y = (settings->gfx_buffer_height - (2 * rows)) / 2;
+
+        shown_width = cols;
+        shown_height = rows;
+        shown_colors = malloc(2 * sizeof(uint32_t) * shown_width * shown_height);
+        truecolor_output = malloc(((size_t)shown_width * shown_height * TRUECOLOR_CELL_BYTES_MAX) + TRUECOLOR_FRAME_TAIL_BYTES);
+
+        if (shown_colors == NULL || truecolor_output == NULL)
+        {
+            debug_log("Could not allocate the truecolor cell buffers.");
+            free(shown_colors);
+            free(truecolor_output);
+            shown_colors = NULL;
+            truecolor_output = NULL;
+            free(*gfx_buffer_pptr);
+            *gfx_buffer_pptr = NULL;
+            return false;
+        }
+
+        memset(shown_colors, 0xFF, 2 * sizeof(uint32_t) * shown_width * shown_height);
+        debug_log("Terminal takes truecolor, drawing half-block cells in 24-bit color.");
+    }
+    else
+    {
+        shown_width = settings->gfx_buffer_width;
+        shown_height = settings->gfx_buffer_height;
+        shown_cells = malloc((size_t)shown_width * shown_height);
+
+        if (shown_cells == NULL)
+        {
+            debug_log("Could not allocate the shown cell buffer.");
+            free(*gfx_buffer_pptr);
+            *gfx_buffer_pptr = NULL;
+            return false;
+        }
+
+        memset(shown_cells, CELL_UNKNOWN, (size_t)shown_width * shown_height);
+    }
+
+    main_window_full_width =     shown_width;
+    main_window_full_height =    shown_height;
 
     main_window_current_width =  main_window_full_width;
     main_window_current_height = main_window_full_height;
@@ -347,6 +864,7 @@ void gfx_init(PlatformSettings_t *settings, Texture_t **gfx_buffer_pptr)
 
     ncurses_is_initialized = true;
     debug_log("Gfx initialized.");
+    return true;
 }
 
 void gfx_deinit(void)
@@ -359,5 +877,18 @@ void gfx_deinit(void)
 
     endwin();
 
+    if (terminal_screen != NULL) delscreen(terminal_screen);
+    if (terminal_output != NULL) fclose(terminal_output);
+    terminal_screen = NULL;
+    terminal_output = NULL;
+
+    free(shown_cells);
+    free(shown_colors);
+    free(truecolor_output);
+    shown_cells = NULL;
+    shown_colors = NULL;
+    truecolor_output = NULL;
+    truecolor_active = false;
+
     ncurses_is_initialized = false;
 }
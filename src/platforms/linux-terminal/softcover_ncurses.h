@@ -7,6 +7,20 @@
 #include "common_structs.h"
 #include "softcover_debug.h"
 
+#define INPUT_POLL_MAX_KEYS (8)
+
+#define TERMINAL_OUTPUT_BUFFER_BYTES (65536)
+#define GFX_FPS_UPDATE_US (500000)
+#define GFX_OUTPUT_REPORT_FRAMES (600)
+/// a color pair no cell is ever drawn with
+#define CELL_UNKNOWN (0xFF)
+/// a color no cell is ever drawn with, as shown colors keep only the low 24 bits of their pixel
+#define TRUECOLOR_UNKNOWN (0xFFFFFFFFu)
+/// the most a half-block cell may take: a cursor move, both colors and the glyph
+#define TRUECOLOR_CELL_BYTES_MAX (51)
+/// room for the fps counter and the closing cursor move and color reset
+#define TRUECOLOR_FRAME_TAIL_BYTES (64)
+
 typedef enum GfxDebugMode
 {
     GFX_DEBUG_NONE = 0,
@@ -17,16 +31,16 @@ typedef enum GfxDebugMode
 
 uint8_t gfx_rgb_to_color_pair(uint8_t r, uint8_t g, uint8_t b);
 int input_read(void);
-void input_push_to_buffer(PlatformSettings_t *settings, UniformRing_t *input_buffer);
+void input_push_to_buffer(PlatformSettings_t *settings, Ring_InputEvent_t *input_buffer);
 GfxDebugMode_t gfx_get_debug_mode(void);
 void gfx_toggle_debug_mode(void);
 void gfx_refresh_debug_window(DebugRing_t *debug_ring, bool is_break);
 void gfx_clear_buffer(Texture_t *gfx_buffer);
-void gfx_sync_buffer(Texture_t *gfx_buffer);
-void gfx_audio_vis(const UniformRing_t *audio_buffer, const PlatformSettings_t *settings, float volume);
-void input_init(PlatformSettings_t *settings, UniformRing_t **input_buffer_pptr);
+void gfx_sync_buffer(Texture_t *gfx_buffer, const GfxDirtyList_t *dirty);
+void gfx_audio_vis(const SpscRing_t *audio_buffer, const PlatformSettings_t *settings, float volume);
+void input_init(PlatformSettings_t *settings, Ring_InputEvent_t **input_buffer_pptr);
 bool gfx_is_initialized(void);
-void gfx_init(PlatformSettings_t *settings, Texture_t **gfx_buffer);
+bool gfx_init(PlatformSettings_t *settings, Texture_t **gfx_buffer);
 void gfx_deinit(void);
 
 #endif
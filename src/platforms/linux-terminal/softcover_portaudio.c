@@ -7,6 +7,7 @@
 static bool audio_is_initialized = false;
 static PaStream *audio_stream = NULL;
 static float audio_volume = 1.0f;
+static uint8_t audio_channels = 2;
 
 static int paStreamCallback(const void *inputBuffer, void *outputBuffer, unsigned long framesPerBuffer,
                            const PaStreamCallbackTimeInfo* timeInfo, PaStreamCallbackFlags statusFlags, void *userData)
@@ -19,20 +20,37 @@ static int paStreamCallback(const void *inputBuffer, void *outputBuffer, unsigne
     (void) statusFlags;
 
     /* Cast data passed through stream to our structure. */
-    UniformRing_t *data = (UniformRing_t*)userData; 
+    SpscRing_t *data = (SpscRing_t*)userData; 
     float *out = (float*)outputBuffer;
-    
-    for(uint32_t i = 0; i < framesPerBuffer; i++)
+
+    /// the output is interleaved, so a buffer holds one sample per channel per frame
+    uint32_t sample_count = framesPerBuffer * audio_channels;
+    uint32_t popped_count = 0;
+
+    /// scale straight out of the ring's storage instead of copying first
+    RingSpan_t spans[2];
+    uint8_t span_count = spsc_read_spans(data, spans);
+
+    for (uint8_t s = 0; s < span_count && popped_count < sample_count; s++)
     {
-        if (ring_pop(data, out+i))
-        {
-            out[i] *= audio_volume;
-        }
-        else
+        const float *src = (const float *)spans[s].ptr;
+        uint32_t span_len = spans[s].len;
+        if (span_len > sample_count - popped_count) span_len = sample_count - popped_count;
+
+        for(uint32_t i = 0; i < span_len; i++)
         {
-            out[i] = 0.0f;
-            continue;
+            out[popped_count+i] = src[i] * audio_volume;
         }
+
+        popped_count += span_len;
+    }
+
+    spsc_commit_read(data, popped_count);
+
+    /// underrun: pad with silence rather than leaving the rest of the buffer undefined
+    for(uint32_t i = popped_count; i < sample_count; i++)
+    {
+        out[i] = 0.0f;
     }
 
     return 0;
@@ -80,7 +98,7 @@ void audio_set_volume(float value)
     audio_volume = value;
 }
 
-void audio_init(PlatformSettings_t *settings, UniformRing_t **audio_buffer_pptr)
+void audio_init(PlatformSettings_t *settings, SpscRing_t **audio_buffer_pptr)
 {
     static char debug_buff[DEBUG_MESSAGE_MAX_LEN] = {0};
 
@@ -89,8 +107,9 @@ void audio_init(PlatformSettings_t *settings, UniformRing_t **audio_buffer_pptr)
     debug_log("Initializing PortAudio.");
 
     /// init audio buffer
-    *audio_buffer_pptr = ring_create(settings->audio_buffer_capacity, sizeof(float));
-    UniformRing_t *audio_buffer = (UniformRing_t *)*audio_buffer_pptr;
+    *audio_buffer_pptr = spsc_create(settings->audio_buffer_capacity, sizeof(float));
+    SpscRing_t *audio_buffer = (SpscRing_t *)*audio_buffer_pptr;
+    audio_channels = settings->audio_channels;
 
     /// init portaudio
     PaError err = paNoError;
@@ -105,7 +124,7 @@ void audio_init(PlatformSettings_t *settings, UniformRing_t **audio_buffer_pptr)
 
     PaStreamParameters output_parameters = {0};
     output_parameters.device = Pa_GetDefaultOutputDevice(); /* default input device */
-    output_parameters.channelCount = 2;
+    output_parameters.channelCount = audio_channels;
     output_parameters.sampleFormat = paFloat32;
     output_parameters.suggestedLatency = Pa_GetDeviceInfo(output_parameters.device)->defaultLowOutputLatency;
     output_parameters.hostApiSpecificStreamInfo = NULL;
@@ -11,7 +11,7 @@
 float audio_get_volume(void);
 void audio_set_volume(float value);
 void audio_set_active(bool active);
-void audio_init(PlatformSettings_t *settings, UniformRing_t **audio_buffer_pptr);
+void audio_init(PlatformSettings_t *settings, SpscRing_t **audio_buffer_pptr);
 void audio_deinit(void);
 
 #endif
@@ -0,0 +1,17 @@
+#ifndef SOFTCOVER_STORAGE_H
+#define SOFTCOVER_STORAGE_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define STORAGE_WRITER_SLOT_COUNT (2)
+#define STORAGE_WRITER_NAME_MAX_LEN (128)
+
+bool storage_writer_init(size_t max_size);
+void storage_writer_deinit(void);
+bool storage_writer_submit(const char *file_name, const void *data, size_t size);
+void storage_writer_poll(void);
+void storage_writer_wait(void);
+
+#endif
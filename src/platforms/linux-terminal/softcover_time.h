@@ -10,6 +10,7 @@ float time_seconds_since_clock(struct timespec *start_clock);
 void time_mark_cycle_start(void);
 void time_mark_cycle_end(int64_t time_target_us);
 int64_t time_get_delta_us(void);
+int64_t time_get_monotonic_us(void);
 int64_t time_get_leftover_us(void);
 
 #endif
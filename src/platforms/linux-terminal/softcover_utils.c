@@ -1,4 +1,5 @@
 #include <errno.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <signal.h>
 #include <string.h>
@@ -13,6 +14,21 @@
 
 #include "tinywav.h"
 
+#include "common_softpak.h"
+
+#ifdef SOFTCOVER_TERMINAL_DITHER
+#define TEXTURE_DITHER (true)
+#else
+#define TEXTURE_DITHER (false)
+#endif
+
+/// one entry per RGB555 color
+#define COLOR_PAIR_LUT_SIZE (1 << 15)
+/// the full range of the ordered dither's offset to each channel
+#define TEXTURE_DITHER_SPREAD (96)
+/// the color pair texels of exactly zero become, which the app takes for transparent
+#define COLOR_PAIR_TRANSPARENT (128)
+
 /**
  * Global flag set by OS termination signals
  * and polled by functions to allow graceful termination.
@@ -25,6 +41,33 @@ bool should_terminate = false;
  */
 static bool random_was_seeded = false;
 
+/**
+ * Format textures are converted to at load, matching the gfx buffer they are drawn into.
+ */
+static PixelFormat_t texture_pixel_format = PIXEL_FORMAT_INDEX8;
+
+/**
+ * Assets baked ahead of time, which the loaders below copy out before turning to the loose files,
+ * see storage_open_asset_pack().
+ */
+static Softpak_t *asset_pack = NULL;
+
+/**
+ * The color pair of every RGB555 color, filled in once color pairs are set as the texture format,
+ * so that quantizing a texel is a single lookup.
+ */
+static uint8_t color_pair_lut[COLOR_PAIR_LUT_SIZE];
+static bool color_pair_lut_is_built = false;
+
+/// 4x4 Bayer matrix, the order in which the ordered dither's thresholds are crossed
+static const uint8_t dither_bayer[4][4] =
+{
+    {  0,  8,  2, 10 },
+    { 12,  4, 14,  6 },
+    {  3, 11,  1,  9 },
+    { 15,  7, 13,  5 },
+};
+
 /**
  * @brief Hooks up OS signals to a custom handler.
  */
@@ -80,12 +123,68 @@ int random_range(int min, int max)
     return random_number;
 }
 
+/**
+ * @brief Returns the process's current resident set size in kilobytes, or 0 if unavailable.
+ */
+size_t memory_get_resident_kb(void)
+{
+    unsigned long total_pages = 0;
+    unsigned long resident_pages = 0;
+
+    FILE *file = fopen("/proc/self/statm", "r");
+    if (file == NULL) return 0;
+
+    if (fscanf(file, "%lu %lu", &total_pages, &resident_pages) != 2) resident_pages = 0;
+    fclose(file);
+
+    return (resident_pages * (size_t)sysconf(_SC_PAGESIZE)) / 1024;
+}
+
+/**
+ * @brief Maps the asset pack baked by the softpak baker, if there is one that this build can read.
+ */
+void storage_open_asset_pack(const char *name)
+{
+    char debug_buff[DEBUG_MESSAGE_MAX_LEN] = {0};
+
+    asset_pack = softpak_open(name);
+
+    if (asset_pack == NULL)
+    {
+        snprintf(debug_buff, sizeof(debug_buff), "No usable asset pack [%s], loading loose files.", name);
+    }
+    else
+    {
+        snprintf(debug_buff, sizeof(debug_buff), "Mapped asset pack [%s] of %u entries.", name, softpak_get_entry_count(asset_pack));
+    }
+
+    debug_log(debug_buff);
+}
+
+void storage_close_asset_pack(void)
+{
+    softpak_close(asset_pack);
+    asset_pack = NULL;
+}
+
 size_t storage_load_text(const char *name, char *dest, size_t max_len)
 {
     char debug_buff[DEBUG_MESSAGE_MAX_LEN] = {0};
 
     if (max_len <= 0) return 0;
 
+    size_t packed_size = 0;
+    const char *packed = softpak_find(asset_pack, name, SOFTPAK_ENTRY_TEXT, 0, &packed_size);
+
+    if (packed != NULL)
+    {
+        /// as much as the line by line read would, which leaves room for a terminating zero
+        size_t len = packed_size < max_len - 1 ? packed_size : max_len - 1;
+        memcpy(dest, packed, len);
+        dest[len] = '\0';
+        return len;
+    }
+
     size_t remaining = max_len;
     size_t read = 0;
 
@@ -127,16 +226,120 @@ size_t storage_load_text(const char *name, char *dest, size_t max_len)
     return read;
 }
 
+/**
+ * @brief Fills the RGB555 color pair table from gfx_rgb_to_color_pair(), see gfx_set_texture_format(),
+ * each entry taking the color at the middle of its 8x8x8 block of RGB888 colors.
+ * That middle is never black, so transparency is left to the loader's exact test of the texel.
+ */
+static void gfx_build_color_pair_lut(void)
+{
+    for (uint32_t i = 0; i < COLOR_PAIR_LUT_SIZE; i++)
+    {
+        uint8_t r = (((i >> 10) & 0x1F) << 3) | 4;
+        uint8_t g = (((i >> 5) & 0x1F) << 3) | 4;
+        uint8_t b = ((i & 0x1F) << 3) | 4;
+
+        color_pair_lut[i] = gfx_rgb_to_color_pair(r, g, b);
+    }
+
+    color_pair_lut_is_built = true;
+}
+
+/**
+ * @brief Sets the format textures are converted to at load; called before any loads,
+ * so that the color pair table is built before textures may be loaded on several threads at once.
+ */
+void gfx_set_texture_format(PixelFormat_t format)
+{
+    texture_pixel_format = format;
+
+    if (format == PIXEL_FORMAT_INDEX8 && !color_pair_lut_is_built) gfx_build_color_pair_lut();
+}
+
+static uint8_t gfx_dither_channel(uint8_t value, int16_t offset)
+{
+    int16_t result = value + offset;
+
+    if (result < 0) return 0;
+    if (result > 255) return 255;
+    return result;
+}
+
+/**
+ * @brief Converts decoded RGB texels to color pairs through the lookup table,
+ * optionally brightening or darkening each texel by its place in the Bayer matrix first, so that areas
+ * of one color near the edge between two color pairs come out as a pattern of both instead of the nearer one alone.
+ */
+static void gfx_quantize_to_color_pairs(const uint8_t *src, uint8_t *dest, uint32_t width, uint32_t height, bool dither)
+{
+    if (!color_pair_lut_is_built) gfx_build_color_pair_lut();
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++, src += 3, dest++)
+        {
+            uint8_t r = src[0];
+            uint8_t g = src[1];
+            uint8_t b = src[2];
+
+            if ((r | g | b) == 0)
+            {
+                *dest = COLOR_PAIR_TRANSPARENT;
+                continue;
+            }
+
+            if (dither)
+            {
+                int16_t offset = ((2 * dither_bayer[y & 3][x & 3]) - 15) * TEXTURE_DITHER_SPREAD / 32;
+                r = gfx_dither_channel(r, offset);
+                g = gfx_dither_channel(g, offset);
+                b = gfx_dither_channel(b, offset);
+            }
+
+            *dest = color_pair_lut[((r >> 3) << 10) | ((g >> 3) << 5) | (b >> 3)];
+        }
+    }
+}
+
+/**
+ * @brief Loads a BMP file and converts it to the current texture format.
+ *
+ * @details
+ * XRGB8888 texels take the transparency test once here, near-black becoming alpha 0,
+ * so the app's per-texel test is a single byte compare and opaque texels copy as whole words.
+ * Otherwise texels become the nearest of the 8 color pairs, see gfx_quantize_to_color_pairs().
+ */
 bool gfx_load_texture(char *name, Texture_t *dest, size_t max_size)
 {
-    static char debug_buff[DEBUG_MESSAGE_MAX_LEN] = {0};
+    char debug_buff[DEBUG_MESSAGE_MAX_LEN] = {0};
 
     uint8_t *temp_buff = NULL;
 
     uint32_t width;
     uint32_t height;
 
-    uint8_t dst_pixel_size_bytes = 1; // ncurses 8 color
+    uint8_t dst_pixel_size_bytes = pixel_format_size_bytes(texture_pixel_format);
+
+    /// a baked texture is already in this format, so it is copied out whole
+    size_t packed_size = 0;
+    const Texture_t *packed = softpak_find(asset_pack, name, SOFTPAK_ENTRY_TEXTURE, texture_pixel_format, &packed_size);
+
+    if (packed != NULL)
+    {
+        if (packed_size > max_size)
+        {
+            snprintf(debug_buff, sizeof(debug_buff), "Requested texture '%s' requires %lu bytes exceeding limit of %lu.", name, packed_size, max_size);
+            debug_log(debug_buff);
+            return false;
+        }
+
+        memcpy(dest, packed, packed_size);
+
+        snprintf(debug_buff, sizeof(debug_buff), "Loaded %s (%dx%dx%d) from the asset pack.",
+            name, dest->width, dest->height, dest->pixel_size_bytes);
+        debug_log(debug_buff);
+        return true;
+    }
 
     uint32_t ret = loadbmp_decode_file(name, &temp_buff, &width, &height, LOADBMP_RGB);
 
@@ -170,10 +373,13 @@ bool gfx_load_texture(char *name, Texture_t *dest, size_t max_size)
     dest->height = height;
     dest->pixel_size_bytes = dst_pixel_size_bytes;
 
-    for (uint16_t pixel = 0; pixel < dst_size; pixel++)
+    if (texture_pixel_format == PIXEL_FORMAT_XRGB8888)
     {
-        uint16_t src_pixel = pixel * 3;
-        dest->pixels[pixel] = gfx_rgb_to_color_pair(temp_buff[src_pixel], temp_buff[src_pixel+1], temp_buff[src_pixel+2]);
+        texels_rgb24_to_xrgb8888((uint32_t *)dest->pixels, temp_buff, (size_t)width * height);
+    }
+    else
+    {
+        gfx_quantize_to_color_pairs(temp_buff, dest->pixels, width, height, TEXTURE_DITHER);
     }
 
     free(temp_buff);
@@ -188,7 +394,26 @@ bool audio_load_wav(char *name, AudioClip_t *dest, size_t max_size)
 {
 #define BLOCK_SIZE (256)
 
-    static char debug_buff[DEBUG_MESSAGE_MAX_LEN] = {0};
+    char debug_buff[DEBUG_MESSAGE_MAX_LEN] = {0};
+
+    size_t packed_size = 0;
+    const AudioClip_t *packed = softpak_find(asset_pack, name, SOFTPAK_ENTRY_SOUND, 0, &packed_size);
+
+    if (packed != NULL)
+    {
+        if (packed_size > max_size)
+        {
+            snprintf(debug_buff, sizeof(debug_buff), "Requestd WAV file '%s' is of size %lu exceeding limit of %lu.", name, packed_size, max_size);
+            debug_log(debug_buff);
+            return false;
+        }
+
+        memcpy(dest, packed, packed_size);
+
+        snprintf(debug_buff, sizeof(debug_buff), "Loaded WAV file '%s' from the asset pack, channels: %u, size: %lu bytes.", name, dest->num_channels, packed_size);
+        debug_log(debug_buff);
+        return true;
+    }
 
     TinyWav tw;
     int ret = tinywav_open_read(&tw, name, TW_INTERLEAVED); // LRLRLRLRLRLRLRLRLR
@@ -4,6 +4,7 @@
 #include <stdbool.h>
 
 #include "common_structs.h"
+#include "common_interface.h"
 
 /**
  * @brief Global flag set by OS termination signals
@@ -15,7 +16,11 @@ void initialize_signal_handler(void);
 void initialize_random_seed(void);
 void signal_handler(int signum);
 int random_range(int min, int max);
+size_t memory_get_resident_kb(void);
+void storage_open_asset_pack(const char *name);
+void storage_close_asset_pack(void);
 size_t storage_load_text(const char *name, char *dest, size_t max_len);
+void gfx_set_texture_format(PixelFormat_t format);
 bool gfx_load_texture(char *name, Texture_t *dest, size_t max_size);
 bool audio_load_wav(char *name, AudioClip_t *dest, size_t max_size);
 
@@ -3,15 +3,20 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <dlfcn.h>                                                                                                                                                                                                                        
 #include <time.h>                                                                                                                                                                                                                         
-#include <sys/stat.h>                                                                                                                                                                                                                     
+#include <sys/stat.h>
+#include <sys/mman.h>                                                                                                                                                                                                                     
 
 #include "common_interface.h"
 #include "common_structs.h"
+#include "common_codec.h"
+#include "common_swapchain.h"
 
 #include "softcover_time.h"
 #include "softcover_utils.h"
+#include "softcover_storage.h"
 #include "softcover_sdl2.h"
 #include "softcover_portaudio.h"
 
@@ -21,8 +26,75 @@ void storage_save_state(char *state_name);
 void storage_load_state(char *state_name);
 bool get_should_terminate(void);
 void set_should_terminate(bool value);
+void workers_run_batch(WorkerJobFunc func, void *context, uint32_t job_count);
 
 static const char *state_filename_format = "%s.state";
+static const char *state_mapped_filename_format = "%s.mapped";
+
+#define MEMORY_HUGE_PAGE_BYTES ((size_t)2 * 1024 * 1024)
+
+#ifdef SOFTCOVER_MEMORY_PREFAULT
+#define MEMORY_PREFAULT (true)
+#else
+#define MEMORY_PREFAULT (false)
+#endif
+
+#ifdef SOFTCOVER_MEMORY_HUGE_PAGES
+#define MEMORY_HUGE_PAGES (true)
+#else
+#define MEMORY_HUGE_PAGES (false)
+#endif
+
+#ifdef SOFTCOVER_MEMORY_LOCK
+#define MEMORY_LOCK (true)
+#else
+#define MEMORY_LOCK (false)
+#endif
+
+/// the state backing the serializable partition with a shared file mapping, if any
+#ifdef SOFTCOVER_STATE_MAPPED_NAME
+#define STATE_MAPPED (true)
+static const char *state_mapped_name = SOFTCOVER_STATE_MAPPED_NAME;
+#else
+#define STATE_MAPPED (false)
+static const char *state_mapped_name = "";
+#endif
+
+/// whether a present thread shows frame N while the main loop simulates and draws frame N+1.
+/// off by default: the present thread touches the window surface while the main loop polls SDL events.
+#ifdef SOFTCOVER_PRESENT_PIPELINED
+#define PRESENT_PIPELINED (true)
+#else
+#define PRESENT_PIPELINED (false)
+#endif
+
+#define PRESENT_REPORT_FRAMES (600)
+
+/// baked by the softpak baker; assets missing from it are loaded from their loose files
+#define ASSET_PACK_NAME "assets.softpak"
+
+#define STATE_FILE_MAGIC (0x4554415453435346ull) // "FSCSTATE"
+#define STATE_FILE_VERSION (2)
+#define STATE_MAPPED_SLOT_COUNT (2)
+
+/// a committed snapshot of the mapped state; generation 0 marks a slot that was never written
+typedef struct StateFileSlot
+{
+    uint64_t generation;
+    uint64_t checksum;
+} StateFileSlot_t;
+
+typedef struct StateFileHeader
+{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t payload_bytes;
+    StateFileSlot_t slots[STATE_MAPPED_SLOT_COUNT];
+} StateFileHeader_t;
+
+static uint8_t *state_mapping = NULL;
+static size_t state_mapping_size = 0;
 
 static char lib_path[128] = SOFTCOVER_APP_FILENAME;
 static char lib_mod_path[132] = "\0";
@@ -36,15 +108,33 @@ static const char *app_setup_name = "app_setup";
 static const char *app_init_name = "app_init";
 static const char *app_loop_name = "app_loop";
 static const char *app_exit_name = "app_exit";
+static const char *app_serialize_name = "app_serialize";
+static const char *app_deserialize_name = "app_deserialize";
 
 static AppSetupFunc app_setup;
 static AppInitFunc app_init;
 static AppLoopFunc app_loop;
 static AppExitFunc app_exit;
+static AppSerializeFunc app_serialize;
+static AppDeserializeFunc app_deserialize;
 
 static void *lib_handle = NULL;
 
 static AppMemoryPartition_t app_memory = {0};
+/// runs the app's parallel batches, created according to the settings once the app is set up
+static WorkerPool_t *worker_pool = NULL;
+/// regions of the gfx buffer changed by the app, the whole buffer until the first frame is presented
+static GfxDirtyList_t gfx_dirty_list = { .full = true };
+/// the last render command list rasterized, so that identical frames are not rasterized again
+static RenderCommandList_t *gfx_commands_previous = NULL;
+/// hands finished frames to the present thread, NULL when presenting serially
+static Swapchain_t *swapchain = NULL;
+static uint32_t present_report_counter = 0;
+
+/// staging for packed saves: the app's packed state and its compressed form
+static size_t state_pack_capacity = 0;
+static uint8_t *state_pack_raw = NULL;
+static uint8_t *state_pack_encoded = NULL;
 
 static const PlatformCapabilities_t capabilities =
 {
@@ -53,7 +143,9 @@ static const PlatformCapabilities_t capabilities =
     .gfx_buffer_max_bytes = 15360,
     .gfx_buffer_width_max = 1920,
     .gfx_buffer_height_max = 1080,
-    .gfx_pixel_max_bytes = 3,
+    .gfx_pixel_max_bytes = 4,
+    .gfx_pixel_formats = PIXEL_FORMAT_BIT(PIXEL_FORMAT_RGB24) | PIXEL_FORMAT_BIT(PIXEL_FORMAT_XRGB8888),
+    .gfx_command_capacity_max = RENDER_COMMANDS_CAPACITY_MAX,
 
     .gfx_frame_time_min_us = 8333,
 
@@ -61,6 +153,8 @@ static const PlatformCapabilities_t capabilities =
     .audio_buffer_capacity_max = 65534,
 
     .input_buffer_capacity_max = 1024,
+
+    .worker_thread_count_max = WORKERS_THREADS_MAX,
 };
 
 static const PlatformSettings_t default_settings =
@@ -68,9 +162,11 @@ static const PlatformSettings_t default_settings =
     .app_memory_serializable_bytes = capabilities.app_memory_max_bytes/10,
     .app_memory_ephemeral_bytes = capabilities.app_memory_max_bytes/10,
 
-    .gfx_pixel_size_bytes = capabilities.gfx_pixel_max_bytes,
+    .gfx_pixel_format = PIXEL_FORMAT_RGB24,
+    .gfx_pixel_size_bytes = 3,
     .gfx_buffer_width = capabilities.gfx_buffer_width_max,
     .gfx_buffer_height = capabilities.gfx_buffer_height_max,
+    .gfx_command_capacity = 0,
 
     .gfx_frame_time_target_us = capabilities.gfx_frame_time_min_us*2,
 
@@ -78,6 +174,8 @@ static const PlatformSettings_t default_settings =
     .audio_buffer_capacity = 16384,
 
     .input_buffer_capacity = 128,
+
+    .worker_thread_count = 1,
 };
 
 static PlatformSettings_t platform_settings = default_settings;
@@ -89,6 +187,7 @@ static const Platform_t platform =
 
     /// time
     .time_get_delta_us = time_get_delta_us,
+    .time_get_monotonic_us = time_get_monotonic_us,
 
     /// audio
     .audio_get_volume = audio_get_volume,
@@ -101,6 +200,9 @@ static const Platform_t platform =
     .storage_save_state = storage_save_state,
     .storage_load_state = storage_load_state,
 
+    /// threads
+    .workers_run = workers_run_batch,
+
     /// utils
     .get_should_terminate = get_should_terminate,
     .set_should_terminate = set_should_terminate,
@@ -108,18 +210,66 @@ static const Platform_t platform =
     .debug_break = debug_break,
 };
 
+/**
+ * @brief Returns the length of the mapping backing a memory chunk of the given size,
+ * rounded up to whole (huge) pages.
+ */
+static size_t memory_mapping_size(size_t size)
+{
+    size_t page_size = MEMORY_HUGE_PAGES ? MEMORY_HUGE_PAGE_BYTES : (size_t)sysconf(_SC_PAGESIZE);
+    size_t total = size + sizeof(Memory_t);
+    return (total + page_size - 1) & ~(page_size - 1);
+}
+
+/**
+ * @brief Maps a zeroed memory chunk from anonymous memory.
+ *
+ * @details
+ * Pages are zero-filled by the kernel on first touch, so startup only pays for what the app uses,
+ * unless MEMORY_PREFAULT asks for the whole chunk to be populated up front.
+ * MEMORY_HUGE_PAGES aligns the chunk to a huge page and advises transparent huge pages,
+ * MEMORY_LOCK pins it in RAM so the frame loop never takes a major fault on it.
+ */
 Memory_t* memory_allocate(size_t size)
 {
-    Memory_t *memory = (Memory_t *)malloc(size + sizeof(Memory_t));
+    size_t mapping_size = memory_mapping_size(size);
+    size_t reserve_size = MEMORY_HUGE_PAGES ? mapping_size + MEMORY_HUGE_PAGE_BYTES : mapping_size;
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | (MEMORY_PREFAULT && !MEMORY_HUGE_PAGES ? MAP_POPULATE : 0);
+
+    uint8_t *reserve = mmap(NULL, reserve_size, PROT_READ | PROT_WRITE, flags, -1, 0);
 
-    if (memory == NULL)
+    if (reserve == MAP_FAILED)
     {
+        int err = errno;
         should_terminate = true;
-        debug_log("Failed to allocate memory chunk.");
+        snprintf(platform_top_debug_buff, sizeof(platform_top_debug_buff), "Failed to map memory chunk: %s", strerror(err));
+        debug_log(platform_top_debug_buff);
         return NULL;
     }
 
-    explicit_bzero(memory->buffer, size);
+    uint8_t *mapping = reserve;
+
+    if (MEMORY_HUGE_PAGES)
+    {
+        /// trim the over-reservation so the chunk starts on a huge page boundary
+        mapping = (uint8_t *)(((uintptr_t)reserve + MEMORY_HUGE_PAGE_BYTES - 1) & ~((uintptr_t)MEMORY_HUGE_PAGE_BYTES - 1));
+        if (mapping > reserve) munmap(reserve, mapping - reserve);
+        if (reserve + reserve_size > mapping + mapping_size) munmap(mapping + mapping_size, (reserve + reserve_size) - (mapping + mapping_size));
+
+#ifdef MADV_HUGEPAGE
+        madvise(mapping, mapping_size, MADV_HUGEPAGE);
+#endif
+        if (MEMORY_PREFAULT) madvise(mapping, mapping_size, MADV_WILLNEED);
+    }
+
+    if (MEMORY_LOCK && mlock(mapping, mapping_size) != 0)
+    {
+        int err = errno;
+        snprintf(platform_top_debug_buff, sizeof(platform_top_debug_buff), "Failed to lock memory chunk: %s", strerror(err));
+        debug_log(platform_top_debug_buff);
+    }
+
+    Memory_t *memory = (Memory_t *)mapping;
     memory->size_bytes = size;
     return memory;
 }
@@ -128,17 +278,191 @@ void memory_release(Memory_t **memory_pptr)
 {
     if (*memory_pptr != NULL)
     {
-        free(*memory_pptr);
+        munmap(*memory_pptr, memory_mapping_size((*memory_pptr)->size_bytes));
         *memory_pptr = NULL;
     }
 }
 
-void storage_save_state(char *state_name)
+/**
+ * @brief Returns the page-rounded length of a mapped state file holding a chunk of the given size.
+ * The first page holds the header, with the Memory_t placed at its end so the buffer is page aligned.
+ * The live chunk is followed by STATE_MAPPED_SLOT_COUNT snapshot slots of the same rounded size.
+ */
+static size_t state_mapping_size_for(size_t size)
+{
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    return page_size + (1 + STATE_MAPPED_SLOT_COUNT) * ((size + page_size - 1) & ~(page_size - 1));
+}
+
+static uint8_t* state_mapping_slot(uint8_t slot_idx)
+{
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    size_t stride = (state_mapping_size - page_size) / (1 + STATE_MAPPED_SLOT_COUNT);
+    return state_mapping + page_size + ((1 + slot_idx) * stride);
+}
+
+/**
+ * @brief Returns the index of the newest snapshot slot whose checksum matches its contents, or -1 if there is none.
+ */
+static int8_t state_mapping_newest_valid_slot(const StateFileHeader_t *header, size_t size)
+{
+    int8_t newest_idx = -1;
+
+    for (uint8_t i = 0; i < STATE_MAPPED_SLOT_COUNT; i++)
+    {
+        const StateFileSlot_t *slot = &header->slots[i];
+
+        if (slot->generation == 0) continue;
+        if (newest_idx >= 0 && slot->generation <= header->slots[newest_idx].generation) continue;
+        if (slot->checksum != codec_checksum(state_mapping_slot(i), size)) continue;
+
+        newest_idx = (int8_t)i;
+    }
+
+    return newest_idx;
+}
+
+/**
+ * @brief Backs a memory chunk with a shared mapping of the named state file.
+ *
+ * @details
+ * The file holds a header (magic, version, payload size, one generation and checksum per slot),
+ * the live chunk, and the snapshot slots written by state_sync_mapping().
+ * The live chunk is restored from the newest slot that passes its checksum.
+ * A slot torn by a crash or by partial writeback fails its checksum and the older slot is used instead,
+ * so at most the latest save is lost; the chunk only starts zeroed if no slot survives.
+ */
+static Memory_t* state_map(const char *state_name, size_t size)
 {
     char file_name[128] = {0};
-    FILE *file = NULL;
+    struct stat file_stat = {0};
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    size_t mapping_size = state_mapping_size_for(size);
 
-    snprintf(file_name, sizeof(file_name), state_filename_format, state_name);
+    snprintf(file_name, sizeof(file_name), state_mapped_filename_format, state_name);
+
+    int fd = open(file_name, O_RDWR | O_CREAT, 0644);
+
+    if (fd < 0 || fstat(fd, &file_stat) != 0
+        || ((size_t)file_stat.st_size != mapping_size && ftruncate(fd, mapping_size) != 0))
+    {
+        int err = errno;
+        should_terminate = true;
+        snprintf(platform_top_debug_buff, sizeof(platform_top_debug_buff), "Failed to open mapped state '%s': %s", file_name, strerror(err));
+        debug_log(platform_top_debug_buff);
+        if (fd >= 0) close(fd);
+        return NULL;
+    }
+
+    uint8_t *mapping = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int err = errno;
+    close(fd);
+
+    if (mapping == MAP_FAILED)
+    {
+        should_terminate = true;
+        snprintf(platform_top_debug_buff, sizeof(platform_top_debug_buff), "Failed to map state '%s': %s", file_name, strerror(err));
+        debug_log(platform_top_debug_buff);
+        return NULL;
+    }
+
+    if (MEMORY_LOCK && mlock(mapping, mapping_size) != 0)
+    {
+        err = errno;
+        snprintf(platform_top_debug_buff, sizeof(platform_top_debug_buff), "Failed to lock mapped state: %s", strerror(err));
+        debug_log(platform_top_debug_buff);
+    }
+
+    state_mapping = mapping;
+    state_mapping_size = mapping_size;
+
+    StateFileHeader_t *header = (StateFileHeader_t *)mapping;
+    Memory_t *memory = (Memory_t *)(mapping + page_size - sizeof(Memory_t));
+    memory->size_bytes = size;
+
+    bool compatible = header->magic == STATE_FILE_MAGIC
+        && header->version == STATE_FILE_VERSION
+        && header->payload_bytes == size;
+    int8_t slot_idx = compatible ? state_mapping_newest_valid_slot(header, size) : -1;
+
+    if (slot_idx >= 0)
+    {
+        memcpy(memory->buffer, state_mapping_slot(slot_idx), size);
+        snprintf(platform_top_debug_buff, sizeof(platform_top_debug_buff), "Restored mapped state '%s' (generation %lu).",
+                file_name, header->slots[slot_idx].generation);
+    }
+    else
+    {
+        bool is_new = header->magic == 0;
+        bzero(mapping, page_size - sizeof(Memory_t));
+        if (!is_new) bzero(memory->buffer, size);
+        snprintf(platform_top_debug_buff, sizeof(platform_top_debug_buff), "Mapped state '%s' %s, starting fresh.",
+                file_name, is_new ? "is new" : "failed validation");
+    }
+
+    header->magic = STATE_FILE_MAGIC;
+    header->version = STATE_FILE_VERSION;
+    header->payload_bytes = size;
+
+    debug_log(platform_top_debug_buff);
+
+    return memory;
+}
+
+/**
+ * @brief Snapshots the live chunk into the older of the two slots and commits it with a checksum and the next generation.
+ *
+ * @details
+ * The newer slot is never touched, so it stays valid however the kernel writes the pages back.
+ * Writeback is only scheduled (MS_ASYNC) unless 'blocking' is set, so the main loop pays for a memcpy and a checksum,
+ * not for disk I/O; 'blocking' is meant for the final sync at exit.
+ */
+static void state_sync_mapping(bool blocking)
+{
+    struct timespec sync_clock;
+    clock_gettime(CLOCK_MONOTONIC, &sync_clock);
+
+    StateFileHeader_t *header = (StateFileHeader_t *)state_mapping;
+    size_t size = app_memory.serializable->size_bytes;
+    uint8_t slot_idx = header->slots[0].generation <= header->slots[1].generation ? 0 : 1;
+    uint64_t generation = 1 + (header->slots[0].generation > header->slots[1].generation
+        ? header->slots[0].generation : header->slots[1].generation);
+    uint8_t *slot_data = state_mapping_slot(slot_idx);
+
+    memcpy(slot_data, app_memory.serializable->buffer, size);
+    header->slots[slot_idx].checksum = codec_checksum(slot_data, size);
+    header->slots[slot_idx].generation = generation;
+
+    if (msync(state_mapping, state_mapping_size, blocking ? MS_SYNC : MS_ASYNC) != 0)
+    {
+        int err = errno;
+        snprintf(platform_top_debug_buff, sizeof(platform_top_debug_buff), "Failed to sync mapped state: %s", strerror(err));
+        debug_log(platform_top_debug_buff);
+        return;
+    }
+
+    snprintf(platform_top_debug_buff, sizeof(platform_top_debug_buff), "Synced mapped state (generation %lu) in %ld us.",
+            generation, time_us_since_clock(&sync_clock));
+    debug_log(platform_top_debug_buff);
+}
+
+static void state_unmap(Memory_t **memory_pptr)
+{
+    if (state_mapping != NULL)
+    {
+        munmap(state_mapping, state_mapping_size);
+        state_mapping = NULL;
+        state_mapping_size = 0;
+        *memory_pptr = NULL;
+    }
+}
+
+/**
+ * @brief Writes a whole file on the calling thread, for when the writer thread is unavailable.
+ */
+static void storage_write_file(const char *file_name, const void *data, size_t size)
+{
+    FILE *file = NULL;
 
     snprintf(platform_top_debug_buff, sizeof(platform_top_debug_buff), "Saving '%s'.", file_name);
     debug_log(platform_top_debug_buff);
@@ -153,21 +477,123 @@ void storage_save_state(char *state_name)
         return;
     }
     
-    fwrite(app_memory.serializable->buffer, 1, app_memory.serializable->size_bytes, file);
+    fwrite(data, 1, size, file);
     fclose(file);
 }
 
+/**
+ * @brief Saves the state in the app's packed form, compressed, if the app provides one.
+ * Only the packed bytes are copied to the writer, so the cost scales with the live state.
+ *
+ * @retval false if the app cannot pack its state, in which case the caller saves the raw partition.
+ */
+static bool storage_save_packed(const char *file_name)
+{
+    if (app_serialize == NULL || state_pack_raw == NULL) return false;
+
+    struct timespec pack_clock;
+    clock_gettime(CLOCK_MONOTONIC, &pack_clock);
+
+    size_t raw_len = app_serialize(state_pack_raw, state_pack_capacity);
+    size_t packed_len = raw_len > 0 ? codec_pack(state_pack_raw, raw_len, state_pack_encoded, codec_pack_bound(state_pack_capacity)) : 0;
+
+    if (packed_len == 0) return false;
+
+    int64_t pack_us = time_us_since_clock(&pack_clock);
+
+    if (storage_writer_submit(file_name, state_pack_encoded, packed_len))
+    {
+        snprintf(platform_top_debug_buff, sizeof(platform_top_debug_buff),
+                "Saving '%s' in the background: %lu state bytes packed to %lu (%lu live) in %ld us.",
+                file_name, app_memory.serializable->size_bytes, packed_len, raw_len, pack_us);
+        debug_log(platform_top_debug_buff);
+    }
+    else
+    {
+        storage_write_file(file_name, state_pack_encoded, packed_len);
+    }
+
+    return true;
+}
+
+void storage_save_state(char *state_name)
+{
+    char file_name[128] = {0};
+
+    if (state_mapping != NULL && strcmp(state_name, state_mapped_name) == 0)
+    {
+        state_sync_mapping(false);
+        return;
+    }
+
+    snprintf(file_name, sizeof(file_name), state_filename_format, state_name);
+
+    if (storage_save_packed(file_name)) return;
+
+    if (storage_writer_submit(file_name, app_memory.serializable->buffer, app_memory.serializable->size_bytes))
+    {
+        snprintf(platform_top_debug_buff, sizeof(platform_top_debug_buff), "Saving '%s' in the background.", file_name);
+        debug_log(platform_top_debug_buff);
+        return;
+    }
+
+    storage_write_file(file_name, app_memory.serializable->buffer, app_memory.serializable->size_bytes);
+}
+
+/**
+ * @brief Validates and expands a packed state file and hands it to the app.
+ * The app state is left untouched if any step fails.
+ */
+static void storage_load_packed(const char *file_name, FILE *file, size_t file_size)
+{
+    struct timespec unpack_clock;
+    clock_gettime(CLOCK_MONOTONIC, &unpack_clock);
+
+    if (app_deserialize == NULL || state_pack_raw == NULL || file_size > codec_pack_bound(state_pack_capacity))
+    {
+        snprintf(platform_top_debug_buff, sizeof(platform_top_debug_buff), "Cannot load packed state '%s' into this app.", file_name);
+        debug_log(platform_top_debug_buff);
+        return;
+    }
+
+    rewind(file);
+
+    size_t raw_len = fread(state_pack_encoded, 1, file_size, file) == file_size
+        ? codec_unpack(state_pack_encoded, file_size, state_pack_raw, state_pack_capacity) : 0;
+
+    if (raw_len == 0 || !app_deserialize(state_pack_raw, raw_len))
+    {
+        snprintf(platform_top_debug_buff, sizeof(platform_top_debug_buff), "Packed state '%s' is corrupt or incompatible.", file_name);
+        debug_log(platform_top_debug_buff);
+        return;
+    }
+
+    snprintf(platform_top_debug_buff, sizeof(platform_top_debug_buff), "Loaded packed state '%s' (%lu bytes, %lu live) in %ld us.",
+            file_name, file_size, raw_len, time_us_since_clock(&unpack_clock));
+    debug_log(platform_top_debug_buff);
+}
+
 void storage_load_state(char *state_name)
 {
     char file_name[128] = {0};
     size_t file_size = 0;
     FILE *file = NULL;
+    CodecPackHeader_t header;
+
+    if (state_mapping != NULL && strcmp(state_name, state_mapped_name) == 0)
+    {
+        debug_log("Mapped state is always current, nothing to load.");
+        return;
+    }
 
     snprintf(file_name, sizeof(file_name), state_filename_format, state_name);
 
     snprintf(platform_top_debug_buff, sizeof(platform_top_debug_buff), "Loading '%s'.", file_name);
     debug_log(platform_top_debug_buff);
 
+    /// a save of this very file may still be in flight
+    storage_writer_wait();
+
     file = fopen(file_name, "rb");
 
     if (file == NULL)
@@ -180,9 +606,26 @@ void storage_load_state(char *state_name)
 
     fseek(file, 0, SEEK_END);
     file_size = ftell(file);
+    rewind(file);
 
+    if (fread(&header, 1, sizeof(header), file) == sizeof(header) && codec_is_packed(&header, sizeof(header)))
+    {
+        storage_load_packed(file_name, file, file_size);
+        fclose(file);
+        return;
+    }
+
+    /// otherwise, a raw copy of the whole partition
     if (file_size != app_memory.serializable->size_bytes)
     {
+        if (state_mapping != NULL)
+        {
+            snprintf(platform_top_debug_buff, sizeof(platform_top_debug_buff), "Size of '%s' does not match the mapped state.", file_name);
+            debug_log(platform_top_debug_buff);
+            fclose(file);
+            return;
+        }
+
         memory_release(&app_memory.serializable);
         app_memory.serializable = memory_allocate(file_size);
     }
@@ -193,6 +636,60 @@ void storage_load_state(char *state_name)
     fclose(file);
 }
 
+/**
+ * @brief Runs a parallel batch on the platform's worker pool, see workers_run().
+ */
+void workers_run_batch(WorkerJobFunc func, void *context, uint32_t job_count)
+{
+    workers_run(worker_pool, func, context, job_count);
+}
+
+/**
+ * @brief Rasterizes the app's render commands into the gfx buffer, then resets the list for the next frame.
+ * A list identical to the last one rasterized leaves the buffer as it is, unless the app marked it all dirty.
+ */
+static void gfx_execute_commands(void)
+{
+    RenderCommandList_t *commands = app_memory.gfx_commands;
+
+    if (app_memory.gfx_dirty->full || !render_list_equals(commands, gfx_commands_previous))
+    {
+        render_execute_parallel(worker_pool, commands, app_memory.ephemeral, app_memory.gfx_buffer);
+        render_list_copy(gfx_commands_previous, commands);
+
+        /// whatever changed without the app reporting it is presented whole
+        if (app_memory.gfx_dirty->count == 0) app_memory.gfx_dirty->full = true;
+    }
+    else
+    {
+        gfx_dirty_reset(app_memory.gfx_dirty, false);
+    }
+
+    render_list_reset(commands);
+}
+
+/**
+ * @brief Logs the swapchain's timings every PRESENT_REPORT_FRAMES frames.
+ */
+static void present_report(void)
+{
+    present_report_counter++;
+
+    if (present_report_counter < PRESENT_REPORT_FRAMES) return;
+
+    SwapchainStats_t stats;
+    swapchain_take_stats(swapchain, &stats);
+    present_report_counter = 0;
+
+    if (stats.frame_count == 0) return;
+
+    snprintf(platform_top_debug_buff, sizeof(platform_top_debug_buff),
+            "Presented %u frames: hand-off %ld us avg (%ld max), present %ld us avg, main loop stalled %ld us avg.",
+            stats.frame_count, stats.handoff_us_total / stats.frame_count, stats.handoff_us_max,
+            stats.present_us_total / stats.frame_count, stats.stall_us_total / stats.frame_count);
+    debug_log(platform_top_debug_buff);
+}
+
 bool get_should_terminate(void)
 {
     return should_terminate;
@@ -224,6 +721,8 @@ static void unload_app(void)
         app_init = NULL;
         app_loop = NULL;
         app_exit = NULL;
+        app_serialize = NULL;
+        app_deserialize = NULL;
     }
 }
 
@@ -247,6 +746,9 @@ static void load_app(void)
     app_init = (AppInitFunc)dlsym(lib_handle, app_init_name);
     app_loop = (AppLoopFunc)dlsym(lib_handle, app_loop_name);
     app_exit = (AppExitFunc)dlsym(lib_handle, app_exit_name);
+    /// optional, saves fall back to raw copies of the partition without them
+    app_serialize = (AppSerializeFunc)dlsym(lib_handle, app_serialize_name);
+    app_deserialize = (AppDeserializeFunc)dlsym(lib_handle, app_deserialize_name);
 
     if (lib_mod_path[0] == '\0')
     {
@@ -277,6 +779,9 @@ int main(int argc, char **argv)
 {
 #define TERMINATION_POINT if (should_terminate) goto platform_termination
 
+    struct timespec startup_clock;
+    clock_gettime(CLOCK_MONOTONIC, &startup_clock);
+
     initialize_signal_handler();
 
     debug_init();
@@ -301,25 +806,88 @@ int main(int argc, char **argv)
     app_setup(&platform);
     TERMINATION_POINT;
 
-    app_memory.serializable = memory_allocate(platform_settings.app_memory_serializable_bytes);
+    app_memory.serializable = STATE_MAPPED
+        ? state_map(state_mapped_name, platform_settings.app_memory_serializable_bytes)
+        : memory_allocate(platform_settings.app_memory_serializable_bytes);
     TERMINATION_POINT;
     app_memory.ephemeral = memory_allocate(platform_settings.app_memory_ephemeral_bytes);
     TERMINATION_POINT;
 
+    /// without the writer thread, saves fall back to writing on the main loop
+    storage_writer_init(platform_settings.app_memory_serializable_bytes);
+    storage_open_asset_pack(ASSET_PACK_NAME);
+
+    state_pack_capacity = platform_settings.app_memory_serializable_bytes;
+    state_pack_raw = malloc(state_pack_capacity);
+    state_pack_encoded = malloc(codec_pack_bound(state_pack_capacity));
+
+    if (state_pack_raw == NULL || state_pack_encoded == NULL)
+    {
+        free(state_pack_raw);
+        free(state_pack_encoded);
+        state_pack_raw = NULL;
+        state_pack_encoded = NULL;
+    }
+
+    /// never more threads than cores, nor than the pool supports
+    long core_count = sysconf(_SC_NPROCESSORS_ONLN);
+    if (platform_settings.worker_thread_count > capabilities.worker_thread_count_max) platform_settings.worker_thread_count = capabilities.worker_thread_count_max;
+    if (core_count > 0 && platform_settings.worker_thread_count > core_count) platform_settings.worker_thread_count = core_count;
+    worker_pool = workers_create(platform_settings.worker_thread_count);
+    platform_settings.worker_thread_count = workers_get_thread_count(worker_pool);
+
+    snprintf(platform_top_debug_buff, sizeof(platform_top_debug_buff), "Worker pool running on %u threads.", platform_settings.worker_thread_count);
+    debug_log(platform_top_debug_buff);
+
     /// initializing platform modules according to given settings
     audio_init(&platform_settings, &app_memory.audio_buffer);
-    gfx_init(&platform_settings, &app_memory.gfx_buffer);
+    if (!gfx_init(&platform_settings, &app_memory.gfx_buffer)) should_terminate = true;
+    TERMINATION_POINT;
+    app_memory.gfx_dirty = &gfx_dirty_list;
+
+    if (platform_settings.gfx_command_capacity > capabilities.gfx_command_capacity_max) platform_settings.gfx_command_capacity = capabilities.gfx_command_capacity_max;
+
+    if (platform_settings.gfx_command_capacity > 0)
+    {
+        app_memory.gfx_commands = render_list_create(platform_settings.gfx_command_capacity);
+        gfx_commands_previous = render_list_create(platform_settings.gfx_command_capacity);
+
+        if (app_memory.gfx_commands == NULL || gfx_commands_previous == NULL)
+        {
+            debug_log("Could not allocate the render command lists, the app will draw into the gfx buffer.");
+            free(app_memory.gfx_commands);
+            free(gfx_commands_previous);
+            app_memory.gfx_commands = NULL;
+            gfx_commands_previous = NULL;
+            platform_settings.gfx_command_capacity = 0;
+        }
+    }
+
     input_init(&platform_settings, &app_memory.input_buffer);
 
+    /// without the present thread, frames fall back to being presented on the main loop
+    if (PRESENT_PIPELINED)
+    {
+        swapchain = swapchain_create(app_memory.gfx_buffer, gfx_sync_buffer);
+        debug_log(swapchain != NULL ? "Presenting frames on a pipelined present thread."
+                : "Could not start the present thread, presenting serially.");
+    }
+
     init_app();
 
     TERMINATION_POINT;
 
+    snprintf(platform_top_debug_buff, sizeof(platform_top_debug_buff),
+            "Startup took %ld us, resident memory %lu KB (prefault %d, huge pages %d, lock %d).",
+            time_us_since_clock(&startup_clock), memory_get_resident_kb(), MEMORY_PREFAULT, MEMORY_HUGE_PAGES, MEMORY_LOCK);
+    debug_log(platform_top_debug_buff);
+
     while(!should_terminate)
     {
         time_mark_cycle_start();
 
         input_push_to_buffer(&platform_settings, app_memory.input_buffer);
+        storage_writer_poll();
 
         if (app_loop != NULL)
         {
@@ -329,7 +897,22 @@ int main(int argc, char **argv)
         {
         }
 
-        gfx_sync_buffer(app_memory.gfx_buffer);
+        if (app_memory.gfx_commands != NULL)
+        {
+            gfx_execute_commands();
+        }
+
+        if (swapchain != NULL)
+        {
+            swapchain_submit(swapchain, app_memory.gfx_buffer, app_memory.gfx_dirty);
+            present_report();
+        }
+        else
+        {
+            gfx_sync_buffer(app_memory.gfx_buffer, app_memory.gfx_dirty);
+        }
+
+        gfx_dirty_reset(app_memory.gfx_dirty, false);
 
         if (gfx_get_debug_mode() == GFX_DEBUG_AUDIO)
         {
@@ -361,13 +944,30 @@ platform_termination:
 
     unload_app();
 
+    /// the present thread draws to the window, so it goes first
+    swapchain_destroy(swapchain);
     audio_deinit();
     gfx_deinit();
 
+    storage_writer_deinit();
+    storage_close_asset_pack();
+    workers_destroy(worker_pool);
+
+    free(state_pack_raw);
+    free(state_pack_encoded);
+
+    if (state_mapping != NULL)
+    {
+        state_sync_mapping(true);
+        state_unmap(&app_memory.serializable);
+    }
+
     memory_release(&app_memory.serializable);
     memory_release(&app_memory.ephemeral);
 
     free(app_memory.gfx_buffer);
+    free(app_memory.gfx_commands);
+    free(gfx_commands_previous);
     free(app_memory.audio_buffer);
 
     debug_log("Terminating.");
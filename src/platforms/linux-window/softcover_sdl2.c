@@ -3,6 +3,7 @@
 #include "softcover_debug.h"
 #include "softcover_time.h"
 
+#include <stdio.h>
 #include <string.h>
 
 static bool sdl_gfx_is_initialized = false;
@@ -12,7 +13,17 @@ static SDL_Window *main_window = NULL;
 static SDL_Window *debug_window = NULL;
 
 static SDL_Surface *main_surface = NULL;
-static SDL_Surface *main_pixels = NULL;
+
+/// surfaces wrapping each buffer presented so far (the gfx buffer itself or swapchain slots), made on first use
+static Texture_t *present_buffers[GFX_PRESENT_BUFFERS_MAX] = {0};
+static SDL_Surface *present_surfaces[GFX_PRESENT_BUFFERS_MAX] = {0};
+static uint8_t present_count = 0;
+
+/// for every window surface column and row, the gfx buffer column and row it samples, see gfx_scale_init()
+static uint16_t *scale_src_columns = NULL;
+static uint16_t *scale_src_rows = NULL;
+/// whether the window surface is 32-bit RGB, which the upscaler writes directly
+static bool scale_direct = false;
 
 static uint16_t main_window_width;
 static uint16_t main_window_height;
@@ -121,11 +132,14 @@ bool input_try_read(InputEvent_t *out)
     return success;
 }
 
-void input_push_to_buffer(PlatformSettings_t *settings, UniformRing_t *input_buffer)
+void input_push_to_buffer(PlatformSettings_t *settings, Ring_InputEvent_t *input_buffer)
 {
     bool buffer_blocked = false;
     InputEvent_t e = {0};
 
+    InputEvent_t batch[INPUT_PUSH_BATCH_LEN];
+    uint32_t batch_len = 0;
+
     while ((!buffer_blocked) && input_try_read(&e))
     {
         if (e.key == SDLK_LEFT && e.value == 1)
@@ -134,47 +148,205 @@ void input_push_to_buffer(PlatformSettings_t *settings, UniformRing_t *input_buf
             continue;
         }
 
-        ring_push(input_buffer, &e, 1, false);
+        batch[batch_len++] = e;
+
+        if (batch_len >= INPUT_PUSH_BATCH_LEN)
+        {
+            buffer_blocked = ring_InputEvent_t_push(input_buffer, batch, batch_len, false) < batch_len;
+            batch_len = 0;
+        }
+    }
+
+    if (batch_len > 0)
+    {
+        ring_InputEvent_t_push(input_buffer, batch, batch_len, false);
     }
 }
 
-void gfx_sync_buffer(Texture_t *gfx_buffer)
+/**
+ * @brief Returns a surface wrapping the given buffer's pixels, creating it the first time,
+ * or NULL if more buffers than GFX_PRESENT_BUFFERS_MAX were presented.
+ */
+static SDL_Surface* gfx_get_present_surface(Texture_t *gfx_buffer)
 {
-    SDL_LockSurface(main_pixels);
-    SDL_FillRect(main_pixels, NULL, 0);
+    for (uint8_t i = 0; i < present_count; i++)
+    {
+        if (present_buffers[i] == gfx_buffer) return present_surfaces[i];
+    }
 
-    memcpy(main_pixels->pixels, gfx_buffer->pixels, gfx_buffer->height*gfx_buffer->width*gfx_buffer->pixel_size_bytes);
-    /*
-    for (size_t i = 0; i < gfx_buffer->width * gfx_buffer->height * gfx_buffer->pixel_size_bytes; i++)
+    if (present_count >= GFX_PRESENT_BUFFERS_MAX) return NULL;
+
+    /// RGB888 is SDL's name for XRGB8888, the window surface's usual format, so scaling into it is a straight copy
+    bool is_xrgb = gfx_buffer->pixel_size_bytes == 4;
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormatFrom(gfx_buffer->pixels,
+        gfx_buffer->width, gfx_buffer->height,
+        is_xrgb ? 32 : 24, gfx_buffer->width * gfx_buffer->pixel_size_bytes,
+        is_xrgb ? SDL_PIXELFORMAT_RGB888 : SDL_PIXELFORMAT_RGB24);
+
+    if (surface == NULL) return NULL;
+
+    SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+
+    present_buffers[present_count] = gfx_buffer;
+    present_surfaces[present_count] = surface;
+    present_count++;
+
+    return surface;
+}
+
+/**
+ * @brief Precomputes the nearest-neighbour mapping from window surface pixels to gfx buffer pixels,
+ * for any ratio, integer or not. Surfaces in a format other than 32-bit RGB keep using SDL_BlitScaled().
+ */
+static void gfx_scale_init(uint16_t src_width, uint16_t src_height, uint8_t src_pixel_size)
+{
+    uint32_t format = main_surface->format->format;
+
+    scale_direct = (format == SDL_PIXELFORMAT_RGB888 || format == SDL_PIXELFORMAT_ARGB8888)
+        && (src_pixel_size == 3 || src_pixel_size == 4);
+
+    if (!scale_direct) return;
+
+    scale_src_columns = malloc(main_surface->w * sizeof(uint16_t));
+    scale_src_rows = malloc(main_surface->h * sizeof(uint16_t));
+
+    if (scale_src_columns == NULL || scale_src_rows == NULL)
     {
-        ((uint8_t *)main_pixels->pixels)[i] = gfx_buffer->pixels[i];
+        free(scale_src_columns);
+        free(scale_src_rows);
+        scale_src_columns = NULL;
+        scale_src_rows = NULL;
+        scale_direct = false;
+        return;
     }
-    */
-    /*
-    for (int32_t y = 0; y < gfx_buffer->height && y < main_pixels->h; y++)
+
+    for (int32_t x = 0; x < main_surface->w; x++)
+    {
+        scale_src_columns[x] = ((int64_t)x * src_width) / main_surface->w;
+    }
+
+    for (int32_t y = 0; y < main_surface->h; y++)
+    {
+        scale_src_rows[y] = ((int64_t)y * src_height) / main_surface->h;
+    }
+}
+
+/**
+ * @brief Upscales into a rectangle of the locked window surface: every row sampling a new buffer row
+ * is gathered through the column table, and every following row sampling the same one is a copy of it.
+ */
+static void gfx_scale_rect(const Texture_t *gfx_buffer, SDL_Rect dst)
+{
+    const uint32_t *previous_row = NULL;
+    int32_t previous_src_y = -1;
+
+    for (int32_t y = dst.y; y < dst.y + dst.h; y++)
     {
-        int32_t row = y * gfx_buffer->width;
+        uint32_t *dst_row = (uint32_t *)((uint8_t *)main_surface->pixels + ((size_t)y * main_surface->pitch)) + dst.x;
+        int32_t src_y = scale_src_rows[y];
+
+        if (src_y == previous_src_y)
+        {
+            memcpy(dst_row, previous_row, dst.w * sizeof(uint32_t));
+            continue;
+        }
 
-        for (int32_t x = 0; x < gfx_buffer->height && x < main_pixels->w; x++)
+        const uint16_t *columns = scale_src_columns + dst.x;
+
+        if (gfx_buffer->pixel_size_bytes == 4)
         {
-            int32_t src_idx = 3 * (row + x);
-            int32_t dst_idx = 4 * (row + x);
+            const uint32_t *src_row = (const uint32_t *)gfx_buffer->pixels + ((size_t)src_y * gfx_buffer->width);
 
-            ((uint8_t *)main_pixels->pixels)[dst_idx+3] = 255;
+            for (int32_t x = 0; x < dst.w; x++)
+            {
+                dst_row[x] = src_row[columns[x]];
+            }
+        }
+        else
+        {
+            const uint8_t *src_row = gfx_buffer->pixels + (3 * (size_t)src_y * gfx_buffer->width);
 
-            for (uint8_t sp = 0; sp < 3; sp++)
+            for (int32_t x = 0; x < dst.w; x++)
             {
-                ((uint8_t *)main_pixels->pixels)[dst_idx+sp] = gfx_buffer->pixels[src_idx+sp];
+                const uint8_t *texel = src_row + (3 * columns[x]);
+                dst_row[x] = ((uint32_t)texel[0] << 16) | ((uint32_t)texel[1] << 8) | texel[2];
             }
         }
+
+        previous_row = dst_row;
+        previous_src_y = src_y;
     }
-    */
-    SDL_UnlockSurface(main_pixels);
-    SDL_BlitScaled(main_pixels, NULL, main_surface, NULL);
-    SDL_UpdateWindowSurface(main_window);
 }
 
-void gfx_audio_vis(const UniformRing_t *audio_buffer, const PlatformSettings_t *settings, float volume)
+/**
+ * @brief Presents the dirty regions of a buffer, or all of it if the list says so.
+ * The upscaler reads the buffer and writes the window surface directly, with no intermediate surface;
+ * the SDL_BlitScaled() fallback scales from a surface wrapping the buffer itself, so there is nothing to copy either way.
+ * Called either from the main loop or from the swapchain's present thread, never from both.
+ * Must match prototype @ref SwapchainPresentFunc.
+ */
+void gfx_sync_buffer(Texture_t *gfx_buffer, const GfxDirtyList_t *dirty)
+{
+    static SDL_Rect dst_rects[GFX_DIRTY_RECTS_MAX];
+
+    SDL_Surface *main_pixels = scale_direct ? NULL : gfx_get_present_surface(gfx_buffer);
+
+    if (!scale_direct && main_pixels == NULL) return;
+    if (dirty != NULL && !dirty->full && dirty->count == 0) return;
+
+    if (scale_direct && SDL_MUSTLOCK(main_surface)) SDL_LockSurface(main_surface);
+
+    if (dirty == NULL || dirty->full)
+    {
+        if (scale_direct)
+        {
+            SDL_Rect dst_rect = { 0, 0, main_surface->w, main_surface->h };
+            gfx_scale_rect(gfx_buffer, dst_rect);
+            if (SDL_MUSTLOCK(main_surface)) SDL_UnlockSurface(main_surface);
+        }
+        else
+        {
+            SDL_BlitScaled(main_pixels, NULL, main_surface, NULL);
+        }
+
+        SDL_UpdateWindowSurface(main_window);
+        return;
+    }
+
+    for (uint32_t i = 0; i < dirty->count; i++)
+    {
+        const GfxRect_t *rect = &dirty->rects[i];
+        SDL_Rect src_rect = { rect->x, rect->y, rect->w, rect->h };
+
+        /// outward rounding, so neighbouring regions leave no unpresented seams between them
+        int32_t min_x = (rect->x * main_surface->w) / gfx_buffer->width;
+        int32_t min_y = (rect->y * main_surface->h) / gfx_buffer->height;
+        int32_t max_x = (((rect->x + rect->w) * main_surface->w) + gfx_buffer->width - 1) / gfx_buffer->width;
+        int32_t max_y = (((rect->y + rect->h) * main_surface->h) + gfx_buffer->height - 1) / gfx_buffer->height;
+
+        dst_rects[i].x = min_x;
+        dst_rects[i].y = min_y;
+        dst_rects[i].w = max_x - min_x;
+        dst_rects[i].h = max_y - min_y;
+
+        SDL_Rect dst_rect = dst_rects[i];
+
+        if (scale_direct)
+        {
+            gfx_scale_rect(gfx_buffer, dst_rect);
+        }
+        else
+        {
+            SDL_BlitScaled(main_pixels, &src_rect, main_surface, &dst_rect);
+        }
+    }
+
+    if (scale_direct && SDL_MUSTLOCK(main_surface)) SDL_UnlockSurface(main_surface);
+
+    SDL_UpdateWindowSurfaceRects(main_window, dst_rects, dirty->count);
+}
+
+void gfx_audio_vis(const SpscRing_t *audio_buffer, const PlatformSettings_t *settings, float volume)
 {
     /*
     werase(debug_window);
@@ -183,18 +355,25 @@ void gfx_audio_vis(const UniformRing_t *audio_buffer, const PlatformSettings_t *
     float min_val = 0.0f;
     float max_abs_val = 0.0f;
 
-    for(uint32_t i = 0; i < audio_buffer->capacity; i++)
+    /// walk the live samples in place rather than copying them out one by one
+    RingSpan_t spans[2];
+    uint8_t span_count = spsc_read_spans(audio_buffer, spans);
+
+    for (uint8_t s = 0; s < span_count; s++)
     {
-        float temp_val = 0.0f;
-        ring_peek(audio_buffer, i, &temp_val, true);
-        if (temp_val > max_val) max_val = temp_val;
-        else if (temp_val < min_val) min_val = temp_val;
+        const float *samples = (const float *)spans[s].ptr;
+
+        for(uint32_t i = 0; i < spans[s].len; i++)
+        {
+            if (samples[i] > max_val) max_val = samples[i];
+            else if (samples[i] < min_val) min_val = samples[i];
+        }
     }
 
     max_abs_val = max_val;
     if (min_val < 0.0f && min_val * -1.0f > max_val) max_abs_val = min_val * -1.0f;
 
-    float norm = ((float)audiovis_mid_row * 0.5f) / max_abs_val;
+    float norm = max_abs_val > 0.0f ? ((float)audiovis_mid_row * 0.5f) / max_abs_val : 0.0f;
 
     mvwprintw(debug_window, 0, 0, "Min: %f Max: %f", min_val, max_val);
 
@@ -220,7 +399,15 @@ void gfx_audio_vis(const UniformRing_t *audio_buffer, const PlatformSettings_t *
 
             float val = 0.0f;
 
-            if (!ring_peek(audio_buffer, count, &val, false))
+            if (count < spans[0].len)
+            {
+                val = ((const float *)spans[0].ptr)[count];
+            }
+            else if (count - spans[0].len < spans[1].len)
+            {
+                val = ((const float *)spans[1].ptr)[count - spans[0].len];
+            }
+            else
             {
                 silence = true;
             }
@@ -259,10 +446,10 @@ void gfx_audio_vis(const UniformRing_t *audio_buffer, const PlatformSettings_t *
     */
 }
 
-void input_init(PlatformSettings_t *settings, UniformRing_t **input_buffer_pptr)
+void input_init(PlatformSettings_t *settings, Ring_InputEvent_t **input_buffer_pptr)
 {
     SDL_Init(SDL_INIT_EVENTS);
-    *input_buffer_pptr = ring_create(settings->input_buffer_capacity, sizeof(InputEvent_t));
+    *input_buffer_pptr = ring_InputEvent_t_create(settings->input_buffer_capacity);
 }
 
 bool gfx_is_initialized(void)
@@ -270,11 +457,30 @@ bool gfx_is_initialized(void)
     return sdl_gfx_is_initialized;
 }
 
-void gfx_init(PlatformSettings_t *settings, Texture_t **gfx_buffer_pptr)
+bool gfx_init(PlatformSettings_t *settings, Texture_t **gfx_buffer_pptr)
 {
-    /// init gfx buffer
-    *gfx_buffer_pptr = (Texture_t *)malloc(sizeof(Texture_t) +
-    (settings->gfx_buffer_width * settings->gfx_buffer_height * settings->gfx_pixel_size_bytes));
+    /// palette indices have no meaning here, fall back to plain RGB
+    if (settings->gfx_pixel_format == PIXEL_FORMAT_INDEX8)
+    {
+        debug_log("Indexed pixel format unsupported, using RGB24.");
+        settings->gfx_pixel_format = PIXEL_FORMAT_RGB24;
+    }
+
+    settings->gfx_pixel_size_bytes = pixel_format_size_bytes(settings->gfx_pixel_format);
+    gfx_set_texture_format(settings->gfx_pixel_format);
+
+    /// init gfx buffer, aligned like every other Texture_t's pixels
+    void *gfx_buffer_memory = NULL;
+
+    if (posix_memalign(&gfx_buffer_memory, COMMON_SIMD_ALIGNMENT, sizeof(Texture_t) +
+        (settings->gfx_buffer_width * settings->gfx_buffer_height * settings->gfx_pixel_size_bytes)) != 0)
+    {
+        debug_log("Could not allocate the gfx buffer.");
+        *gfx_buffer_pptr = NULL;
+        return false;
+    }
+
+    *gfx_buffer_pptr = (Texture_t *)gfx_buffer_memory;
     Texture_t *gfx_buffer = (Texture_t *)*gfx_buffer_pptr;
     memset(gfx_buffer, 0, sizeof(*gfx_buffer));
     gfx_buffer->width = settings->gfx_buffer_width;
@@ -301,22 +507,41 @@ void gfx_init(PlatformSettings_t *settings, Texture_t **gfx_buffer_pptr)
     debug_window = SDL_CreateWindow("Softcover Debug", 0, 0, debug_window_width, debug_window_height, SDL_WINDOW_HIDDEN);
 
     main_surface = SDL_GetWindowSurface(main_window);
-    main_pixels = SDL_CreateRGBSurfaceWithFormat(0, settings->gfx_buffer_width, settings->gfx_buffer_height, 24, SDL_PIXELFORMAT_RGB24);
 
-    SDL_LockSurface(main_pixels);
-    SDL_FillRect(main_pixels, NULL, 0);
-    SDL_UnlockSurface(main_pixels);
-    SDL_BlitSurface(main_pixels, NULL, main_surface, NULL);
+    gfx_scale_init(gfx_buffer->width, gfx_buffer->height, gfx_buffer->pixel_size_bytes);
+
+    char debug_buff[DEBUG_MESSAGE_MAX_LEN];
+    snprintf(debug_buff, sizeof(debug_buff), "Presenting %ux%u to %dx%d with %s.",
+            gfx_buffer->width, gfx_buffer->height, main_surface->w, main_surface->h,
+            scale_direct ? "the direct upscaler" : "SDL_BlitScaled");
+    debug_log(debug_buff);
+
+    SDL_FillRect(main_surface, NULL, 0);
     SDL_UpdateWindowSurface(main_window);
 
     SDL_RaiseWindow(main_window);
 
     sdl_gfx_is_initialized = true;
     debug_log("Gfx initialized.");
+    return true;
 }
 
 void gfx_deinit(void)
 {
+    for (uint8_t i = 0; i < present_count; i++)
+    {
+        SDL_FreeSurface(present_surfaces[i]);
+        present_surfaces[i] = NULL;
+        present_buffers[i] = NULL;
+    }
+
+    present_count = 0;
+
+    free(scale_src_columns);
+    free(scale_src_rows);
+    scale_src_columns = NULL;
+    scale_src_rows = NULL;
+    scale_direct = false;
 
     if (main_window != NULL) SDL_DestroyWindow(main_window);
 
@@ -7,8 +7,13 @@
 
 #include "common_interface.h"
 #include "common_structs.h"
+#include "common_swapchain.h"
 #include "softcover_debug.h"
 
+#define INPUT_PUSH_BATCH_LEN (16)
+/// the gfx buffer and the swapchain slots
+#define GFX_PRESENT_BUFFERS_MAX (1 + SWAPCHAIN_SLOT_COUNT)
+
 typedef enum GfxDebugMode
 {
     GFX_DEBUG_NONE = 0,
@@ -18,16 +23,16 @@ typedef enum GfxDebugMode
 } GfxDebugMode_t;
 
 bool input_try_read(InputEvent_t *out);
-void input_push_to_buffer(PlatformSettings_t *settings, UniformRing_t *input_buffer);
+void input_push_to_buffer(PlatformSettings_t *settings, Ring_InputEvent_t *input_buffer);
 GfxDebugMode_t gfx_get_debug_mode(void);
 void gfx_toggle_debug_mode(void);
 void gfx_refresh_debug_window(DebugRing_t *debug_ring, bool is_break);
 void gfx_clear_buffer(Texture_t *gfx_buffer);
-void gfx_sync_buffer(Texture_t *gfx_buffer);
-void gfx_audio_vis(const UniformRing_t *audio_buffer, const PlatformSettings_t *settings, float volume);
-void input_init(PlatformSettings_t *settings, UniformRing_t **input_buffer_pptr);
+void gfx_sync_buffer(Texture_t *gfx_buffer, const GfxDirtyList_t *dirty);
+void gfx_audio_vis(const SpscRing_t *audio_buffer, const PlatformSettings_t *settings, float volume);
+void input_init(PlatformSettings_t *settings, Ring_InputEvent_t **input_buffer_pptr);
 bool gfx_is_initialized(void);
-void gfx_init(PlatformSettings_t *settings, Texture_t **gfx_buffer);
+bool gfx_init(PlatformSettings_t *settings, Texture_t **gfx_buffer);
 void gfx_deinit(void);
 
 #endif
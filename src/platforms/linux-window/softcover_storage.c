@@ -0,0 +1,289 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "softcover_storage.h"
+#include "softcover_time.h"
+#include "softcover_debug.h"
+
+/**
+ * A single background thread that writes state snapshots to disk.
+ *
+ * The main loop copies the state into a free snapshot slot and hands it over,
+ * so it never waits on file I/O; the writer owns a slot only while writing it.
+ * With two slots, a save requested while another is being written still gets its own snapshot,
+ * and a newer request replaces one that is still waiting.
+ * Results are collected by storage_writer_poll() on the main thread, which also does all the logging.
+ */
+
+typedef struct StorageWriterSlot
+{
+    char file_name[STORAGE_WRITER_NAME_MAX_LEN];
+    size_t size;
+    uint8_t *data;
+} StorageWriterSlot_t;
+
+typedef struct StorageWriterResult
+{
+    char file_name[STORAGE_WRITER_NAME_MAX_LEN];
+    size_t size;
+    int64_t elapsed_us;
+    int error;
+} StorageWriterResult_t;
+
+typedef struct StorageWriter
+{
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+
+    /// guarded by the mutex
+    int8_t pending_idx;
+    int8_t writing_idx;
+    bool quit;
+    bool has_result;
+    StorageWriterResult_t result;
+
+    size_t max_size;
+    StorageWriterSlot_t slots[STORAGE_WRITER_SLOT_COUNT];
+} StorageWriter_t;
+
+static StorageWriter_t writer = {0};
+static bool writer_running = false;
+static char storage_debug_buff[DEBUG_MESSAGE_MAX_LEN];
+
+/**
+ * @brief Writes the slot to a temporary file and renames it over the target,
+ * so the target always holds either the previous or the new state in full.
+ *
+ * @retval 0 on success, otherwise the errno of the failed step.
+ */
+static int storage_writer_write_slot(const StorageWriterSlot_t *slot)
+{
+    char temp_name[STORAGE_WRITER_NAME_MAX_LEN + 4] = {0};
+    snprintf(temp_name, sizeof(temp_name), "%s.tmp", slot->file_name);
+
+    FILE *file = fopen(temp_name, "wb");
+
+    if (file == NULL) return errno;
+
+    bool written = fwrite(slot->data, 1, slot->size, file) == slot->size
+        && fflush(file) == 0
+        && fsync(fileno(file)) == 0;
+    int err = errno;
+
+    fclose(file);
+
+    if (!written)
+    {
+        unlink(temp_name);
+        return err != 0 ? err : EIO;
+    }
+
+    if (rename(temp_name, slot->file_name) != 0) return errno;
+
+    return 0;
+}
+
+static void* storage_writer_thread(void *arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&writer.mutex);
+
+    for(;;)
+    {
+        while (writer.pending_idx < 0 && !writer.quit)
+        {
+            pthread_cond_wait(&writer.cond, &writer.mutex);
+        }
+
+        /// pending saves are still written when quitting
+        if (writer.pending_idx < 0) break;
+
+        writer.writing_idx = writer.pending_idx;
+        writer.pending_idx = -1;
+        StorageWriterSlot_t *slot = &writer.slots[writer.writing_idx];
+
+        pthread_mutex_unlock(&writer.mutex);
+
+        struct timespec write_clock;
+        clock_gettime(CLOCK_MONOTONIC, &write_clock);
+        int err = storage_writer_write_slot(slot);
+        int64_t elapsed_us = time_us_since_clock(&write_clock);
+
+        pthread_mutex_lock(&writer.mutex);
+
+        memcpy(writer.result.file_name, slot->file_name, sizeof(writer.result.file_name));
+        writer.result.size = slot->size;
+        writer.result.elapsed_us = elapsed_us;
+        writer.result.error = err;
+        writer.has_result = true;
+        writer.writing_idx = -1;
+        pthread_cond_broadcast(&writer.cond);
+    }
+
+    pthread_mutex_unlock(&writer.mutex);
+
+    return NULL;
+}
+
+/**
+ * @brief Allocates the snapshot slots and starts the writer thread.
+ */
+bool storage_writer_init(size_t max_size)
+{
+    writer.pending_idx = -1;
+    writer.writing_idx = -1;
+    writer.quit = false;
+    writer.has_result = false;
+    writer.max_size = max_size;
+
+    for (uint8_t i = 0; i < STORAGE_WRITER_SLOT_COUNT; i++)
+    {
+        writer.slots[i].data = malloc(max_size);
+
+        if (writer.slots[i].data == NULL)
+        {
+            debug_log("Failed to allocate storage writer snapshots.");
+            storage_writer_deinit();
+            return false;
+        }
+    }
+
+    pthread_mutex_init(&writer.mutex, NULL);
+    pthread_cond_init(&writer.cond, NULL);
+
+    if (pthread_create(&writer.thread, NULL, storage_writer_thread, NULL) != 0)
+    {
+        debug_log("Failed to start storage writer thread.");
+        pthread_mutex_destroy(&writer.mutex);
+        pthread_cond_destroy(&writer.cond);
+        storage_writer_deinit();
+        return false;
+    }
+
+    writer_running = true;
+    return true;
+}
+
+/**
+ * @brief Finishes any pending save, stops the writer thread and frees the snapshot slots.
+ */
+void storage_writer_deinit(void)
+{
+    if (writer_running)
+    {
+        pthread_mutex_lock(&writer.mutex);
+        writer.quit = true;
+        pthread_cond_broadcast(&writer.cond);
+        pthread_mutex_unlock(&writer.mutex);
+
+        pthread_join(writer.thread, NULL);
+
+        /// reports the last save's result while the mutex is still up
+        storage_writer_poll();
+        writer_running = false;
+
+        pthread_mutex_destroy(&writer.mutex);
+        pthread_cond_destroy(&writer.cond);
+    }
+
+    for (uint8_t i = 0; i < STORAGE_WRITER_SLOT_COUNT; i++)
+    {
+        free(writer.slots[i].data);
+        writer.slots[i].data = NULL;
+    }
+}
+
+/**
+ * @brief Snapshots the given data and queues it to be written to the named file.
+ *
+ * @details
+ * Costs one memcpy on the calling thread. If an earlier snapshot is still waiting for the writer,
+ * it is replaced, since the newer state supersedes it.
+ *
+ * @retval false if the writer is not running or the data exceeds the snapshot size.
+ */
+bool storage_writer_submit(const char *file_name, const void *data, size_t size)
+{
+    if (!writer_running || size > writer.max_size) return false;
+
+    pthread_mutex_lock(&writer.mutex);
+
+    int8_t slot_idx = writer.pending_idx >= 0 ? writer.pending_idx : (writer.writing_idx == 0 ? 1 : 0);
+    /// withdrawn while being filled, so the writer cannot pick it up half-copied
+    writer.pending_idx = -1;
+
+    pthread_mutex_unlock(&writer.mutex);
+
+    StorageWriterSlot_t *slot = &writer.slots[slot_idx];
+    snprintf(slot->file_name, sizeof(slot->file_name), "%s", file_name);
+    memcpy(slot->data, data, size);
+    slot->size = size;
+
+    pthread_mutex_lock(&writer.mutex);
+    writer.pending_idx = slot_idx;
+    pthread_cond_signal(&writer.cond);
+    pthread_mutex_unlock(&writer.mutex);
+
+    return true;
+}
+
+/**
+ * @brief Reports a completed save, if any. Called from the main loop.
+ */
+void storage_writer_poll(void)
+{
+    StorageWriterResult_t result;
+    bool has_result = false;
+
+    /// without the writer thread the mutex was never set up, or is already torn down
+    if (!writer_running || pthread_mutex_trylock(&writer.mutex) != 0) return;
+
+    if (writer.has_result)
+    {
+        result = writer.result;
+        writer.has_result = false;
+        has_result = true;
+    }
+
+    pthread_mutex_unlock(&writer.mutex);
+
+    if (!has_result) return;
+
+    if (result.error == 0)
+    {
+        snprintf(storage_debug_buff, sizeof(storage_debug_buff), "Saved '%s' (%lu bytes) in %ld us.",
+                result.file_name, result.size, result.elapsed_us);
+    }
+    else
+    {
+        snprintf(storage_debug_buff, sizeof(storage_debug_buff), "Failed to save '%s': %s",
+                result.file_name, strerror(result.error));
+    }
+
+    debug_log(storage_debug_buff);
+}
+
+/**
+ * @brief Blocks until no save is pending or being written,
+ * e.g. before reading back a file that may still be in flight.
+ */
+void storage_writer_wait(void)
+{
+    if (!writer_running) return;
+
+    pthread_mutex_lock(&writer.mutex);
+
+    while (writer.pending_idx >= 0 || writer.writing_idx >= 0)
+    {
+        pthread_cond_wait(&writer.cond, &writer.mutex);
+    }
+
+    pthread_mutex_unlock(&writer.mutex);
+
+    storage_writer_poll();
+}
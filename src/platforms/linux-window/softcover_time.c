@@ -71,3 +71,13 @@ int64_t time_get_leftover_us(void)
 {
     return last_cycle_leftover_us;
 }
+
+/**
+ * @brief Returns a monotonic timestamp in microseconds, for measuring spans of work.
+ */
+int64_t time_get_monotonic_us(void)
+{
+    struct timespec now_clock;
+    clock_gettime(CLOCK_MONOTONIC, &now_clock);
+    return ((int64_t)now_clock.tv_sec * 1000000) + (now_clock.tv_nsec / 1000);
+}
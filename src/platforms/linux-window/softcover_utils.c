@@ -1,4 +1,5 @@
 #include <errno.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <signal.h>
 #include <string.h>
@@ -13,6 +14,8 @@
 
 #include "tinywav.h"
 
+#include "common_softpak.h"
+
 /**
  * Global flag set by OS termination signals
  * and polled by functions to allow graceful termination.
@@ -25,6 +28,17 @@ bool should_terminate = false;
  */
 static bool random_was_seeded = false;
 
+/**
+ * Format textures are converted to at load, matching the gfx buffer they are drawn into.
+ */
+static PixelFormat_t texture_pixel_format = PIXEL_FORMAT_RGB24;
+
+/**
+ * Assets baked ahead of time, which the loaders below copy out before turning to the loose files,
+ * see storage_open_asset_pack().
+ */
+static Softpak_t *asset_pack = NULL;
+
 /**
  * @brief Hooks up OS signals to a custom handler.
  */
@@ -80,12 +94,68 @@ int random_range(int min, int max)
     return random_number;
 }
 
+/**
+ * @brief Returns the process's current resident set size in kilobytes, or 0 if unavailable.
+ */
+size_t memory_get_resident_kb(void)
+{
+    unsigned long total_pages = 0;
+    unsigned long resident_pages = 0;
+
+    FILE *file = fopen("/proc/self/statm", "r");
+    if (file == NULL) return 0;
+
+    if (fscanf(file, "%lu %lu", &total_pages, &resident_pages) != 2) resident_pages = 0;
+    fclose(file);
+
+    return (resident_pages * (size_t)sysconf(_SC_PAGESIZE)) / 1024;
+}
+
+/**
+ * @brief Maps the asset pack baked by the softpak baker, if there is one that this build can read.
+ */
+void storage_open_asset_pack(const char *name)
+{
+    char debug_buff[DEBUG_MESSAGE_MAX_LEN] = {0};
+
+    asset_pack = softpak_open(name);
+
+    if (asset_pack == NULL)
+    {
+        snprintf(debug_buff, sizeof(debug_buff), "No usable asset pack [%s], loading loose files.", name);
+    }
+    else
+    {
+        snprintf(debug_buff, sizeof(debug_buff), "Mapped asset pack [%s] of %u entries.", name, softpak_get_entry_count(asset_pack));
+    }
+
+    debug_log(debug_buff);
+}
+
+void storage_close_asset_pack(void)
+{
+    softpak_close(asset_pack);
+    asset_pack = NULL;
+}
+
 size_t storage_load_text(const char *name, char *dest, size_t max_len)
 {
     char debug_buff[DEBUG_MESSAGE_MAX_LEN] = {0};
 
     if (max_len <= 0) return 0;
 
+    size_t packed_size = 0;
+    const char *packed = softpak_find(asset_pack, name, SOFTPAK_ENTRY_TEXT, 0, &packed_size);
+
+    if (packed != NULL)
+    {
+        /// as much as the line by line read would, which leaves room for a terminating zero
+        size_t len = packed_size < max_len - 1 ? packed_size : max_len - 1;
+        memcpy(dest, packed, len);
+        dest[len] = '\0';
+        return len;
+    }
+
     size_t remaining = max_len;
     size_t read = 0;
 
@@ -127,16 +197,49 @@ size_t storage_load_text(const char *name, char *dest, size_t max_len)
     return read;
 }
 
+void gfx_set_texture_format(PixelFormat_t format)
+{
+    texture_pixel_format = format;
+}
+
+/**
+ * @brief Loads a BMP file and converts it to the current texture format.
+ *
+ * @details
+ * XRGB8888 texels take the transparency test once here, near-black becoming alpha 0,
+ * so the app's per-texel test is a single byte compare and opaque texels copy as whole words.
+ */
 bool gfx_load_texture(char *name, Texture_t *dest, size_t max_size)
 {
-    static char debug_buff[DEBUG_MESSAGE_MAX_LEN] = {0};
+    char debug_buff[DEBUG_MESSAGE_MAX_LEN] = {0};
 
     uint8_t *temp_buff = NULL;
 
     uint32_t width;
     uint32_t height;
 
-    uint8_t dst_pixel_size_bytes = 3; // RGB for now
+    uint8_t dst_pixel_size_bytes = pixel_format_size_bytes(texture_pixel_format);
+
+    /// a baked texture is already in this format, so it is copied out whole
+    size_t packed_size = 0;
+    const Texture_t *packed = softpak_find(asset_pack, name, SOFTPAK_ENTRY_TEXTURE, texture_pixel_format, &packed_size);
+
+    if (packed != NULL)
+    {
+        if (packed_size > max_size)
+        {
+            snprintf(debug_buff, sizeof(debug_buff), "Requested texture '%s' requires %lu bytes exceeding limit of %lu.", name, packed_size, max_size);
+            debug_log(debug_buff);
+            return false;
+        }
+
+        memcpy(dest, packed, packed_size);
+
+        snprintf(debug_buff, sizeof(debug_buff), "Loaded %s (%dx%dx%d) from the asset pack.",
+            name, dest->width, dest->height, dest->pixel_size_bytes);
+        debug_log(debug_buff);
+        return true;
+    }
 
     uint32_t ret = loadbmp_decode_file(name, &temp_buff, &width, &height, LOADBMP_RGB);
 
@@ -170,9 +273,16 @@ bool gfx_load_texture(char *name, Texture_t *dest, size_t max_size)
     dest->height = height;
     dest->pixel_size_bytes = dst_pixel_size_bytes;
 
-    for (size_t i = 0; i < dst_size; i++)
+    if (texture_pixel_format == PIXEL_FORMAT_XRGB8888)
+    {
+        texels_rgb24_to_xrgb8888((uint32_t *)dest->pixels, temp_buff, (size_t)width * height);
+    }
+    else
     {
-        dest->pixels[i] = temp_buff[i];
+        for (size_t i = 0; i < dst_size; i++)
+        {
+            dest->pixels[i] = temp_buff[i];
+        }
     }
 
     free(temp_buff);
@@ -187,7 +297,26 @@ bool audio_load_wav(char *name, AudioClip_t *dest, size_t max_size)
 {
 #define BLOCK_SIZE (256)
 
-    static char debug_buff[DEBUG_MESSAGE_MAX_LEN] = {0};
+    char debug_buff[DEBUG_MESSAGE_MAX_LEN] = {0};
+
+    size_t packed_size = 0;
+    const AudioClip_t *packed = softpak_find(asset_pack, name, SOFTPAK_ENTRY_SOUND, 0, &packed_size);
+
+    if (packed != NULL)
+    {
+        if (packed_size > max_size)
+        {
+            snprintf(debug_buff, sizeof(debug_buff), "Requestd WAV file '%s' is of size %lu exceeding limit of %lu.", name, packed_size, max_size);
+            debug_log(debug_buff);
+            return false;
+        }
+
+        memcpy(dest, packed, packed_size);
+
+        snprintf(debug_buff, sizeof(debug_buff), "Loaded WAV file '%s' from the asset pack, channels: %u, size: %lu bytes.", name, dest->num_channels, packed_size);
+        debug_log(debug_buff);
+        return true;
+    }
 
     TinyWav tw;
     int ret = tinywav_open_read(&tw, name, TW_INTERLEAVED); // LRLRLRLRLRLRLRLRLR
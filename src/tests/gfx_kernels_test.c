@@ -0,0 +1,213 @@
+/**
+ * Checks the app's vector keyed row kernels against the scalar reference, then times them all.
+ * Every row width up to GFX_TEST_WIDTH_MAX is tried, so every vector tail length is covered,
+ * with source and destination at odd offsets and guard bytes around the row that must stay untouched.
+ * Rows mix opaque texels with keyed ones, RGB24 sums just past the key included.
+ *
+ * Usage: gfx_kernels_test [benchmark rows, GFX_TEST_BENCH_DEFAULT_ROWS if omitted]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "app_gfx_kernels.h"
+
+#define GFX_TEST_WIDTH_MAX (300)
+#define GFX_TEST_TRIALS (40)
+#define GFX_TEST_GUARD_BYTES (64)
+#define GFX_TEST_BENCH_WIDTH (64)
+#define GFX_TEST_BENCH_DEFAULT_ROWS (200000)
+
+typedef struct GfxTestKernel
+{
+    const char *name;
+    GfxKeyedRowFunc func;
+    uint8_t pixel_size;
+    bool needs_avx2;
+} GfxTestKernel_t;
+
+static const GfxTestKernel_t kernels[] =
+{
+    { "rgb24 scalar", gfx_keyed_row_scalar, 3, false },
+#ifdef GFX_KERNELS_X86
+    { "rgb24 sse2", gfx_keyed_row_sse2, 3, false },
+    { "rgb24 avx2", gfx_keyed_row_avx2, 3, true },
+#endif
+    { "xrgb scalar", gfx_keyed_row_xrgb_scalar, 4, false },
+#ifdef GFX_KERNELS_X86
+    { "xrgb sse2", gfx_keyed_row_xrgb_sse2, 4, false },
+    { "xrgb avx2", gfx_keyed_row_xrgb_avx2, 4, true },
+#endif
+};
+
+#define GFX_TEST_KERNEL_COUNT (sizeof(kernels) / sizeof(kernels[0]))
+#define GFX_TEST_BUFFER_BYTES ((GFX_TEST_WIDTH_MAX * 4) + (2 * GFX_TEST_GUARD_BYTES))
+
+static bool gfx_test_kernel_supported(const GfxTestKernel_t *kernel)
+{
+#ifdef GFX_KERNELS_X86
+    if (kernel->needs_avx2) return __builtin_cpu_supports("avx2");
+#endif
+    (void)kernel;
+    return true;
+}
+
+/**
+ * @brief Fills a row with random texels, about half of them transparent, some of those right at the key.
+ */
+static void gfx_test_fill_row(uint8_t *row, uint32_t width, uint8_t pixel_size)
+{
+    for (uint32_t i = 0; i < width; i++)
+    {
+        uint8_t *texel = &row[i * pixel_size];
+        int choice = rand() % 4;
+
+        for (uint8_t c = 0; c < pixel_size; c++) texel[c] = rand();
+
+        if (pixel_size == 4)
+        {
+            if (choice < 2) texel[3] = 0;
+            else if (choice == 2) texel[3] = 1 + (rand() % 255);
+            continue;
+        }
+
+        /// sums right at and just past the key, then fully random ones
+        if (choice < 2)
+        {
+            uint8_t sum = GFX_KEY_SUM_MAX + choice;
+            texel[0] = rand() % (sum + 1);
+            texel[1] = rand() % (sum - texel[0] + 1);
+            texel[2] = sum - texel[0] - texel[1];
+        }
+        else if (choice == 2)
+        {
+            texel[0] = texel[1] = texel[2] = 0;
+        }
+    }
+}
+
+/**
+ * @retval The number of kernel runs whose output differed from the scalar reference's.
+ */
+static uint32_t gfx_test_correctness(void)
+{
+    static uint8_t src[GFX_TEST_BUFFER_BYTES];
+    static uint8_t dst_initial[GFX_TEST_BUFFER_BYTES];
+    static uint8_t dst_expected[GFX_TEST_BUFFER_BYTES];
+    static uint8_t dst_actual[GFX_TEST_BUFFER_BYTES];
+    uint32_t failures = 0;
+
+    for (size_t k = 0; k < GFX_TEST_KERNEL_COUNT; k++)
+    {
+        const GfxTestKernel_t *kernel = &kernels[k];
+        GfxKeyedRowFunc reference = kernel->pixel_size == 4 ? gfx_keyed_row_xrgb_scalar : gfx_keyed_row_scalar;
+
+        if (!gfx_test_kernel_supported(kernel))
+        {
+            printf("%-12s  skipped, not supported by this CPU\n", kernel->name);
+            continue;
+        }
+
+        uint32_t kernel_failures = 0;
+
+        for (uint32_t width = 0; width <= GFX_TEST_WIDTH_MAX; width++)
+        {
+            for (uint32_t trial = 0; trial < GFX_TEST_TRIALS; trial++)
+            {
+                uint32_t src_offset = GFX_TEST_GUARD_BYTES - (trial % 4);
+                uint32_t dst_offset = GFX_TEST_GUARD_BYTES - ((trial / 4) % 4);
+
+                for (size_t i = 0; i < GFX_TEST_BUFFER_BYTES; i++) dst_initial[i] = rand();
+                memset(src, 0, sizeof(src));
+                gfx_test_fill_row(src + src_offset, width, kernel->pixel_size);
+
+                memcpy(dst_expected, dst_initial, sizeof(dst_initial));
+                memcpy(dst_actual, dst_initial, sizeof(dst_initial));
+                reference(dst_expected + dst_offset, src + src_offset, width);
+                kernel->func(dst_actual + dst_offset, src + src_offset, width);
+
+                if (memcmp(dst_expected, dst_actual, sizeof(dst_actual)) != 0)
+                {
+                    if (kernel_failures < 4) printf("%-12s  differs at width %u, trial %u\n", kernel->name, width, trial);
+                    kernel_failures++;
+                }
+            }
+        }
+
+        printf("%-12s  %u of %u rows differ from the scalar reference\n",
+            kernel->name, kernel_failures, (GFX_TEST_WIDTH_MAX + 1) * GFX_TEST_TRIALS);
+        failures += kernel_failures;
+    }
+
+    return failures;
+}
+
+static int64_t gfx_test_now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((int64_t)now.tv_sec * 1000000000) + now.tv_nsec;
+}
+
+/**
+ * @brief Times every kernel over rows with opaque and transparent stretches of the given length.
+ */
+static void gfx_test_benchmark(uint32_t rows, uint32_t run_len)
+{
+    static uint8_t src[GFX_TEST_BENCH_WIDTH * 4];
+    static uint8_t dst[GFX_TEST_BENCH_WIDTH * 4];
+
+    printf("runs of %2u: ", run_len);
+
+    for (size_t k = 0; k < GFX_TEST_KERNEL_COUNT; k++)
+    {
+        const GfxTestKernel_t *kernel = &kernels[k];
+        if (!gfx_test_kernel_supported(kernel)) continue;
+
+        uint8_t pixel_size = kernel->pixel_size;
+        memset(src, 0, sizeof(src));
+
+        for (uint32_t i = 0; i < GFX_TEST_BENCH_WIDTH; i++)
+        {
+            if ((i / run_len) % 2 != 0) continue;
+            memset(&src[i * pixel_size], 0x80, pixel_size);
+        }
+
+        int64_t start_ns = gfx_test_now_ns();
+
+        for (uint32_t r = 0; r < rows; r++)
+        {
+            kernel->func(dst, src, GFX_TEST_BENCH_WIDTH);
+            /// keeps the stores from being folded across iterations
+            __asm__ volatile("" : : "r"(dst) : "memory");
+        }
+
+        printf(" %s %.1f", kernel->name, (double)(gfx_test_now_ns() - start_ns) / rows);
+    }
+
+    printf("  (ns per %u-texel row)\n", GFX_TEST_BENCH_WIDTH);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t bench_rows = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : GFX_TEST_BENCH_DEFAULT_ROWS;
+
+#ifdef GFX_KERNELS_X86
+    __builtin_cpu_init();
+#endif
+
+    printf("Selected keyed kernels: %s.\n", gfx_kernels_init());
+
+    srand(1);
+    uint32_t failures = gfx_test_correctness();
+
+    for (uint32_t run_len = 2; run_len <= GFX_TEST_BENCH_WIDTH; run_len *= 2)
+    {
+        gfx_test_benchmark(bench_rows, run_len);
+    }
+
+    printf("%s.\n", failures == 0 ? "passed" : "FAILED");
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,136 @@
+/**
+ * Microbenchmark of the uniform ring's bulk copies against the per-unit loop they replaced.
+ * Pushes a clip of float samples at a time and drains it in audio-callback-sized pops,
+ * once through a copy of the old per-unit push and pop and once through ring_push() and ring_pop_bulk(),
+ * and checks that both deliver the same samples in the same order.
+ *
+ * Usage: ring_bench [repetitions, RING_BENCH_DEFAULT_REPS if omitted]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "common_structs.h"
+
+#define RING_BENCH_DEFAULT_REPS (200)
+#define RING_BENCH_CAPACITY (65534)
+#define RING_BENCH_CLIP_SAMPLES (30000)
+#define RING_BENCH_POP_SAMPLES (512)
+
+/**
+ * @brief The ring_push() this benchmark compares against: one modulo and one memcpy per unit.
+ */
+static uint32_t ring_push_per_unit(UniformRing_t *ring, void *chunk, uint32_t len)
+{
+    uint8_t *cast_chunk = (uint8_t *)chunk;
+    uint32_t start_idx = (ring->head + ring->length) % ring->capacity;
+    uint32_t pushed_count = 0;
+
+    for (uint32_t i = 0; i < len && ring->length < ring->capacity; i++)
+    {
+        uint32_t idx = (start_idx + i) % ring->capacity;
+        memcpy(ring->buffer+(idx*ring->unit_size), cast_chunk+(i*ring->unit_size), ring->unit_size);
+        ring->length++;
+        pushed_count++;
+    }
+
+    return pushed_count;
+}
+
+/**
+ * @brief The ring_pop() this benchmark compares against, called once per unit.
+ */
+static bool ring_pop_per_unit(UniformRing_t *ring, void *out)
+{
+    if (ring->length == 0) return false;
+
+    memcpy(out, ring->buffer+(ring->head*ring->unit_size), ring->unit_size);
+    ring->head = (ring->head + 1) % ring->capacity;
+    ring->length--;
+    return true;
+}
+
+static int64_t ring_bench_now_us(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((int64_t)now.tv_sec * 1000000) + (now.tv_nsec / 1000);
+}
+
+/**
+ * @brief Pushes the clip and drains the ring 'reps' times, writing everything popped to 'drained'.
+ *
+ * @retval The elapsed time in microseconds.
+ */
+static int64_t ring_bench_run(UniformRing_t *ring, float *clip, float *drained, uint32_t reps, bool bulk)
+{
+    int64_t start_us = ring_bench_now_us();
+
+    for (uint32_t rep = 0; rep < reps; rep++)
+    {
+        uint32_t popped = 0;
+
+        if (bulk) ring_push(ring, clip, RING_BENCH_CLIP_SAMPLES, false);
+        else ring_push_per_unit(ring, clip, RING_BENCH_CLIP_SAMPLES);
+
+        while (ring->length > 0)
+        {
+            if (bulk)
+            {
+                popped += ring_pop_bulk(ring, &drained[popped], RING_BENCH_POP_SAMPLES);
+                continue;
+            }
+
+            for (uint32_t i = 0; i < RING_BENCH_POP_SAMPLES && ring_pop_per_unit(ring, &drained[popped]); i++)
+            {
+                popped++;
+            }
+        }
+    }
+
+    return ring_bench_now_us() - start_us;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t reps = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : RING_BENCH_DEFAULT_REPS;
+
+    UniformRing_t *ring = ring_create(RING_BENCH_CAPACITY, sizeof(float));
+    float *clip = malloc(RING_BENCH_CLIP_SAMPLES * sizeof(float));
+    float *drained_per_unit = calloc(RING_BENCH_CLIP_SAMPLES, sizeof(float));
+    float *drained_bulk = calloc(RING_BENCH_CLIP_SAMPLES, sizeof(float));
+
+    if (ring == NULL || clip == NULL || drained_per_unit == NULL || drained_bulk == NULL)
+    {
+        fprintf(stderr, "Cannot allocate the benchmark buffers.\n");
+        return EXIT_FAILURE;
+    }
+
+    for (uint32_t i = 0; i < RING_BENCH_CLIP_SAMPLES; i++)
+    {
+        clip[i] = (float)i / RING_BENCH_CLIP_SAMPLES;
+    }
+
+    /// both runs start from the same head, partway into the ring, so pushes and pops wrap
+    ring->head = RING_BENCH_CAPACITY - (RING_BENCH_CLIP_SAMPLES / 3);
+    int64_t per_unit_us = ring_bench_run(ring, clip, drained_per_unit, reps, false);
+
+    ring->head = RING_BENCH_CAPACITY - (RING_BENCH_CLIP_SAMPLES / 3);
+    int64_t bulk_us = ring_bench_run(ring, clip, drained_bulk, reps, true);
+
+    bool passed = memcmp(drained_per_unit, clip, RING_BENCH_CLIP_SAMPLES * sizeof(float)) == 0
+        && memcmp(drained_bulk, clip, RING_BENCH_CLIP_SAMPLES * sizeof(float)) == 0;
+
+    printf("Pushed and drained %u floats %u times: per-unit %ld us, bulk %ld us (%.1fx): %s.\n",
+        RING_BENCH_CLIP_SAMPLES, reps, per_unit_us, bulk_us,
+        bulk_us > 0 ? (double)per_unit_us / bulk_us : 0.0, passed ? "passed" : "FAILED");
+
+    free(ring);
+    free(clip);
+    free(drained_per_unit);
+    free(drained_bulk);
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,154 @@
+/**
+ * Stress test for the single-producer single-consumer ring.
+ * A producer thread pushes a sequence of counters in chunks of varying length as fast as the ring takes them,
+ * while a consumer thread drains it, alternating between spsc_pop() and reading in place through spsc_read_spans(),
+ * and checks that every counter arrives once and in order.
+ *
+ * Usage: spsc_stress [unit count, SPSC_STRESS_DEFAULT_COUNT if omitted]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "common_spsc.h"
+
+#define SPSC_STRESS_DEFAULT_COUNT (20000000u)
+#define SPSC_STRESS_CAPACITY (1024)
+#define SPSC_STRESS_CHUNK_MAX (97)
+
+typedef struct SpscStress
+{
+    SpscRing_t *ring;
+    uint32_t count;
+    uint32_t received;
+    uint32_t errors;
+} SpscStress_t;
+
+static void* spsc_stress_produce(void *arg)
+{
+    SpscStress_t *stress = (SpscStress_t *)arg;
+    uint32_t chunk[SPSC_STRESS_CHUNK_MAX];
+    uint32_t next = 0;
+    uint32_t chunk_len = 1;
+
+    while (next < stress->count)
+    {
+        uint32_t len = stress->count - next < chunk_len ? stress->count - next : chunk_len;
+
+        for (uint32_t i = 0; i < len; i++)
+        {
+            chunk[i] = next + i;
+        }
+
+        /// a full ring takes only part of the chunk, the rest is regenerated on the next attempt
+        uint32_t pushed = spsc_push(stress->ring, chunk, len);
+        next += pushed;
+
+        /// lets the consumer run when both share a core
+        if (pushed == 0) sched_yield();
+
+        chunk_len = (chunk_len % SPSC_STRESS_CHUNK_MAX) + 1;
+    }
+
+    return NULL;
+}
+
+static void spsc_stress_check(SpscStress_t *stress, uint32_t value)
+{
+    if (value != stress->received)
+    {
+        if (stress->errors < 8) fprintf(stderr, "Expected %u, received %u.\n", stress->received, value);
+        stress->errors++;
+        stress->received = value;
+    }
+
+    stress->received++;
+}
+
+static void* spsc_stress_consume(void *arg)
+{
+    SpscStress_t *stress = (SpscStress_t *)arg;
+    uint32_t chunk[SPSC_STRESS_CHUNK_MAX];
+    bool in_place = false;
+
+    while (stress->received < stress->count)
+    {
+        if (spsc_length(stress->ring) == 0)
+        {
+            sched_yield();
+            continue;
+        }
+
+        if (in_place)
+        {
+            RingSpan_t spans[2];
+            uint8_t span_count = spsc_read_spans(stress->ring, spans);
+            uint32_t total = 0;
+
+            for (uint8_t s = 0; s < span_count; s++)
+            {
+                for (uint32_t i = 0; i < spans[s].len; i++)
+                {
+                    spsc_stress_check(stress, ((uint32_t *)spans[s].ptr)[i]);
+                }
+
+                total += spans[s].len;
+            }
+
+            spsc_commit_read(stress->ring, total);
+        }
+        else
+        {
+            uint32_t len = spsc_pop(stress->ring, chunk, SPSC_STRESS_CHUNK_MAX);
+
+            for (uint32_t i = 0; i < len; i++)
+            {
+                spsc_stress_check(stress, chunk[i]);
+            }
+        }
+
+        in_place = !in_place;
+    }
+
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    SpscStress_t stress = {0};
+    stress.count = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : SPSC_STRESS_DEFAULT_COUNT;
+    stress.ring = spsc_create(SPSC_STRESS_CAPACITY, sizeof(uint32_t));
+
+    if (stress.ring == NULL)
+    {
+        fprintf(stderr, "Cannot create the ring.\n");
+        return EXIT_FAILURE;
+    }
+
+    pthread_t producer;
+    pthread_t consumer;
+
+    if (pthread_create(&producer, NULL, spsc_stress_produce, &stress) != 0)
+    {
+        fprintf(stderr, "Cannot start the producer.\n");
+        return EXIT_FAILURE;
+    }
+
+    if (pthread_create(&consumer, NULL, spsc_stress_consume, &stress) != 0)
+    {
+        fprintf(stderr, "Cannot start the consumer.\n");
+        return EXIT_FAILURE;
+    }
+
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+
+    bool passed = stress.errors == 0 && stress.received == stress.count && spsc_length(stress.ring) == 0;
+    printf("Moved %u units through a ring of %u, %u out of order: %s.\n",
+        stress.received, SPSC_STRESS_CAPACITY, stress.errors, passed ? "passed" : "FAILED");
+
+    free(stress.ring);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
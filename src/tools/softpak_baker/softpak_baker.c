@@ -0,0 +1,280 @@
+/**
+ * Bakes the assets listed by the index files of an asset directory into a single asset pack,
+ * which the platforms map at startup and load from instead of decoding the loose files.
+ * Textures are baked in every pixel format the window platform draws in, sounds as float samples,
+ * and the index files, definitions and scenes as they are.
+ *
+ * Run from the asset directory: softpak_baker [output file, SOFTPAK_DEFAULT_NAME if omitted]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common_interface.h"
+#include "common_softpak.h"
+
+#define LOADBMP_IMPLEMENTATION
+#include "loadbmp.h"
+
+#include "tinywav.h"
+
+#define SOFTPAK_DEFAULT_NAME "assets.softpak"
+#define BAKER_ENTRIES_MAX (512)
+#define BAKER_TEXT_MAX_BYTES (1024*1024)
+#define BAKER_WAV_BLOCK_SIZE (256)
+
+static const PixelFormat_t baked_texture_formats[] = { PIXEL_FORMAT_RGB24, PIXEL_FORMAT_XRGB8888 };
+
+static FILE *output = NULL;
+static uint64_t output_offset = 0;
+static SoftpakEntry_t entries[BAKER_ENTRIES_MAX];
+static uint32_t entry_count = 0;
+
+static bool baker_write(const void *data, size_t size)
+{
+    if (size > 0 && fwrite(data, size, 1, output) != 1) return false;
+
+    output_offset += size;
+    return true;
+}
+
+/**
+ * @brief Appends a payload at the next aligned offset and lists it in the table of contents.
+ */
+static bool baker_add(const char *name, SoftpakEntryType_t type, uint32_t format, const void *data, size_t size)
+{
+    static const uint8_t padding[SOFTPAK_ALIGNMENT] = {0};
+
+    if (entry_count >= BAKER_ENTRIES_MAX || strlen(name) >= SOFTPAK_NAME_MAX_LEN)
+    {
+        fprintf(stderr, "Cannot add '%s': too many entries or too long a name.\n", name);
+        return false;
+    }
+
+    if (!baker_write(padding, (SOFTPAK_ALIGNMENT - (output_offset % SOFTPAK_ALIGNMENT)) % SOFTPAK_ALIGNMENT)) return false;
+
+    SoftpakEntry_t *entry = &entries[entry_count];
+    memset(entry, 0, sizeof(*entry));
+    snprintf(entry->name, sizeof(entry->name), "%s", name);
+    entry->type = type;
+    entry->format = format;
+    entry->offset = output_offset;
+    entry->size = size;
+
+    if (!baker_write(data, size)) return false;
+
+    entry_count++;
+    return true;
+}
+
+/**
+ * @brief Reads a whole file into a new buffer, with a terminating zero past its end.
+ */
+static char* baker_read_text(const char *name, size_t *size_out)
+{
+    FILE *file = fopen(name, "r");
+
+    if (file == NULL)
+    {
+        fprintf(stderr, "Cannot open '%s'.\n", name);
+        return NULL;
+    }
+
+    char *text = malloc(BAKER_TEXT_MAX_BYTES + 1);
+
+    if (text == NULL)
+    {
+        fclose(file);
+        return NULL;
+    }
+
+    *size_out = fread(text, 1, BAKER_TEXT_MAX_BYTES, file);
+    text[*size_out] = '\0';
+    fclose(file);
+
+    return text;
+}
+
+static bool baker_add_text(const char *name)
+{
+    size_t size = 0;
+    char *text = baker_read_text(name, &size);
+
+    if (text == NULL) return false;
+
+    bool success = baker_add(name, SOFTPAK_ENTRY_TEXT, 0, text, size);
+    free(text);
+
+    return success;
+}
+
+/**
+ * @brief Decodes a BMP file and bakes it once per pixel format, converted the way the platforms' loaders do.
+ */
+static bool baker_add_texture(const char *name)
+{
+    uint8_t *decoded = NULL;
+    uint32_t width;
+    uint32_t height;
+
+    if (loadbmp_decode_file(name, &decoded, &width, &height, LOADBMP_RGB) != 0 || decoded == NULL)
+    {
+        fprintf(stderr, "Cannot decode texture '%s'.\n", name);
+        return false;
+    }
+
+    bool success = true;
+
+    for (size_t f = 0; success && f < sizeof(baked_texture_formats) / sizeof(baked_texture_formats[0]); f++)
+    {
+        PixelFormat_t format = baked_texture_formats[f];
+        uint8_t pixel_size = pixel_format_size_bytes(format);
+        size_t size = sizeof(Texture_t) + ((size_t)width * height * pixel_size);
+        void *memory = NULL;
+
+        if (posix_memalign(&memory, COMMON_SIMD_ALIGNMENT, size) != 0)
+        {
+            success = false;
+            break;
+        }
+
+        Texture_t *texture = (Texture_t *)memory;
+        memset(texture, 0, size);
+        texture->width = width;
+        texture->height = height;
+        texture->pixel_size_bytes = pixel_size;
+
+        if (format == PIXEL_FORMAT_XRGB8888)
+        {
+            texels_rgb24_to_xrgb8888((uint32_t *)texture->pixels, decoded, (size_t)width * height);
+        }
+        else
+        {
+            memcpy(texture->pixels, decoded, (size_t)width * height * pixel_size);
+        }
+
+        success = baker_add(name, SOFTPAK_ENTRY_TEXTURE, format, texture, size);
+        free(memory);
+    }
+
+    free(decoded);
+    return success;
+}
+
+/**
+ * @brief Decodes a WAV file to interleaved float samples and bakes them as an AudioClip_t.
+ */
+static bool baker_add_sound(const char *name)
+{
+    TinyWav tw;
+
+    if (tinywav_open_read(&tw, name, TW_INTERLEAVED) < 0)
+    {
+        fprintf(stderr, "Cannot decode sound '%s'.\n", name);
+        return false;
+    }
+
+    uint32_t num_samples = tw.h.Subchunk2Size / tw.h.NumChannels * tw.h.BitsPerSample / 8;
+    size_t size = sizeof(AudioClip_t) + (sizeof(float) * num_samples);
+    void *memory = NULL;
+
+    if (posix_memalign(&memory, COMMON_SIMD_ALIGNMENT, size) != 0)
+    {
+        tinywav_close_read(&tw);
+        return false;
+    }
+
+    AudioClip_t *clip = (AudioClip_t *)memory;
+    memset(clip, 0, size);
+    clip->num_channels = tw.h.NumChannels;
+    clip->num_samples = num_samples;
+
+    for (uint32_t index = 0; index < num_samples; index += BAKER_WAV_BLOCK_SIZE)
+    {
+        uint32_t to_read = num_samples - index > BAKER_WAV_BLOCK_SIZE ? BAKER_WAV_BLOCK_SIZE : num_samples - index;
+        tinywav_read_f(&tw, &clip->samples[index], to_read);
+    }
+
+    tinywav_close_read(&tw);
+
+    bool success = baker_add(name, SOFTPAK_ENTRY_SOUND, 0, clip, size);
+    free(memory);
+
+    return success;
+}
+
+/**
+ * @brief Bakes an index file and every asset it lists, one per line as the app reads them.
+ *
+ * @retval The number of assets that could not be baked.
+ */
+static uint32_t baker_add_listed(const char *list_name, bool (*add)(const char *name))
+{
+    size_t size = 0;
+    char *text = baker_read_text(list_name, &size);
+
+    if (text == NULL) return 1;
+
+    uint32_t failures = baker_add(list_name, SOFTPAK_ENTRY_TEXT, 0, text, size) ? 0 : 1;
+    char *line = text;
+
+    while (line != NULL)
+    {
+        char *next_line = strchr(line, '\n');
+        if (next_line) *next_line = '\0';
+
+        if (strlen(line) > 5 && line[0] != '#' && !add(line)) failures++;
+
+        line = next_line ? next_line + 1 : NULL;
+    }
+
+    free(text);
+    return failures;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *output_name = argc > 1 ? argv[1] : SOFTPAK_DEFAULT_NAME;
+
+    output = fopen(output_name, "wb");
+
+    if (output == NULL)
+    {
+        fprintf(stderr, "Cannot create '%s'.\n", output_name);
+        return EXIT_FAILURE;
+    }
+
+    /// the header is written again once the table of contents' place is known
+    SoftpakHeader_t header = {0};
+    memcpy(header.magic, SOFTPAK_MAGIC, sizeof(SOFTPAK_MAGIC));
+    header.version = SOFTPAK_VERSION;
+    header.texture_header_bytes = sizeof(Texture_t);
+    header.clip_header_bytes = sizeof(AudioClip_t);
+
+    uint32_t failures = baker_write(&header, sizeof(header)) ? 0 : 1;
+
+    failures += baker_add_listed("textures.soft", baker_add_texture);
+    failures += baker_add_listed("sounds.soft", baker_add_sound);
+    failures += baker_add_listed("scenes.soft", baker_add_text);
+    failures += baker_add_text("definitions.soft") ? 0 : 1;
+
+    static const uint8_t padding[sizeof(uint64_t)] = {0};
+    baker_write(padding, (sizeof(uint64_t) - (output_offset % sizeof(uint64_t))) % sizeof(uint64_t));
+
+    header.entry_count = entry_count;
+    header.toc_offset = output_offset;
+
+    if (!baker_write(entries, entry_count * sizeof(SoftpakEntry_t))
+        || fseek(output, 0, SEEK_SET) != 0
+        || fwrite(&header, sizeof(header), 1, output) != 1)
+    {
+        failures++;
+    }
+
+    if (fclose(output) != 0) failures++;
+
+    printf("Baked %u entries into '%s' (%lu bytes), %u failures.\n", entry_count, output_name, output_offset, failures);
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}